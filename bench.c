@@ -0,0 +1,338 @@
+/**
+ * @file bench.c
+ * @brief Medição de desempenho das operações do grafo sobre mapas sintéticos.
+ *
+ * Gera um mapa de antenas com o tamanho, a densidade, o número de frequências
+ * e a assimetria pedidos, e mede cada operação em separado. Para cada uma
+ * escreve o tempo por operação (ns/op), o número de alocações por operação e
+ * o pico de memória residente do processo, em CSV (por omissão) ou JSON.
+ *
+ * Uso: benchmark [--largura=N] [--altura=N] [--densidade=D] [--frequencias=N]
+ *                [--assimetria=S] [--repeticoes=N] [--semente=N] [--json]
+ *
+ * As alocações são contadas envolvendo malloc/calloc/realloc com a opção
+ * --wrap do linker (ver o alvo bench da makefile).
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <stdatomic.h>
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+#include "functest.h"
+
+#define BENCH_MAPA "bench_mapa.txt"          ///< Mapa sintético gerado (apagado no fim)
+#define BENCH_ARESTAS "bench_arestas.bin"    ///< Ficheiro de arestas temporário
+#define BENCH_INSTANTANEO "bench_grafo.bin"  ///< Instantâneo temporário
+
+/// @brief Parâmetros do mapa sintético e da medição
+typedef struct ConfigBench {
+    int largura;               ///< Colunas do mapa
+    int altura;                ///< Linhas do mapa
+    double densidade;          ///< Probabilidade de cada posição ter uma antena
+    int numFreqs;              ///< Número de frequências diferentes (até 62)
+    double assimetria;         ///< Expoente de Zipf: 0 = frequências equiprováveis
+    int repeticoes;            ///< Repetições das operações rápidas (bfs, dfs, ...)
+    unsigned int semente;      ///< Semente do gerador pseudoaleatório
+    bool json;                 ///< Saída em JSON em vez de CSV
+} ConfigBench;
+
+/// @brief Resultado da medição de uma operação
+typedef struct Medicao {
+    const char* operacao;      ///< Nome da operação
+    long ops;                  ///< Número de vezes que foi executada
+    double ns_por_op;          ///< Tempo médio por execução
+    double alocacoes_por_op;   ///< Alocações (malloc/calloc/realloc) médias por execução
+    long pico_rss_kb;          ///< Pico de memória residente do processo depois da operação (-1 se indisponível)
+} Medicao;
+
+static atomic_size_t alocacoes; ///< Alocações feitas desde o início do programa
+
+void* __real_malloc(size_t n);
+void* __real_calloc(size_t n, size_t tam);
+void* __real_realloc(void* p, size_t n);
+
+void* __wrap_malloc(size_t n) {
+    atomic_fetch_add_explicit(&alocacoes, 1, memory_order_relaxed);
+    return __real_malloc(n);
+}
+
+void* __wrap_calloc(size_t n, size_t tam) {
+    atomic_fetch_add_explicit(&alocacoes, 1, memory_order_relaxed);
+    return __real_calloc(n, tam);
+}
+
+void* __wrap_realloc(void* p, size_t n) {
+    atomic_fetch_add_explicit(&alocacoes, 1, memory_order_relaxed);
+    return __real_realloc(p, n);
+}
+
+/**
+ * @brief Devolve um instante em nanossegundos, de um relógio monótono.
+ */
+
+static double agoraNs(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (double)t.tv_sec * 1e9 + (double)t.tv_nsec;
+}
+
+/**
+ * @brief Devolve o pico de memória residente do processo em KB (-1 se não for possível saber).
+ */
+
+static long picoRSS(void) {
+#ifndef _WIN32
+    struct rusage uso;
+    if (getrusage(RUSAGE_SELF, &uso) != 0) return -1;
+    return uso.ru_maxrss; // em KB no Linux
+#else
+    return -1;
+#endif
+}
+
+/**
+ * @brief Escreve um mapa sintético no formato de exemplo.txt.
+ *
+ * A frequência de cada antena segue uma distribuição de Zipf com o expoente
+ * cfg->assimetria sobre cfg->numFreqs símbolos, para simular frequências muito
+ * mais usadas do que outras.
+ *
+ * @param cfg Parâmetros do mapa.
+ * @param nomeFicheiro Ficheiro a criar.
+ *
+ * @return long Número de antenas escritas, ou -1 em caso de erro.
+ */
+
+static long gerarMapa(const ConfigBench* cfg, const char* nomeFicheiro) {
+    static const char simbolos[] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz";
+    double acumulado[62];
+    double soma = 0.0;
+    for (int f = 0; f < cfg->numFreqs; f++) {
+        soma += 1.0 / pow(f + 1, cfg->assimetria);
+        acumulado[f] = soma;
+    }
+
+    FILE* ficheiro = fopen(nomeFicheiro, "w");
+    char* linha = malloc((size_t)cfg->largura + 2);
+    if (!ficheiro || !linha) {
+        if (ficheiro) fclose(ficheiro);
+        free(linha);
+        return -1;
+    }
+
+    long antenas = 0;
+    srand(cfg->semente);
+    for (int y = 0; y < cfg->altura; y++) {
+        for (int x = 0; x < cfg->largura; x++) {
+            linha[x] = '.';
+            if ((double)rand() / RAND_MAX >= cfg->densidade) continue;
+            double sorteio = (double)rand() / RAND_MAX * soma;
+            int f = 0;
+            while (f < cfg->numFreqs - 1 && acumulado[f] < sorteio) f++;
+            linha[x] = simbolos[f];
+            antenas++;
+        }
+        linha[cfg->largura] = '\n';
+        fwrite(linha, 1, (size_t)cfg->largura + 1, ficheiro);
+    }
+
+    free(linha);
+    fclose(ficheiro);
+    return antenas;
+}
+
+/**
+ * @brief Começa a medir uma operação.
+ *
+ * @param m Medição a preencher.
+ * @param operacao Nome da operação.
+ * @param inicioNs Recebe o instante inicial.
+ * @param inicioAloc Recebe o número de alocações até agora.
+ */
+
+static void comecar(Medicao* m, const char* operacao, double* inicioNs, size_t* inicioAloc) {
+    m->operacao = operacao;
+    *inicioAloc = atomic_load(&alocacoes);
+    *inicioNs = agoraNs();
+}
+
+/**
+ * @brief Acaba de medir uma operação e escreve a linha correspondente.
+ *
+ * @param cfg Parâmetros (para o formato de saída).
+ * @param m Medição.
+ * @param ops Número de vezes que a operação foi executada.
+ * @param inicioNs Instante inicial.
+ * @param inicioAloc Alocações no início.
+ * @param primeira true se for a primeira linha (para as vírgulas do JSON).
+ */
+
+static void terminar(const ConfigBench* cfg, Medicao* m, long ops, double inicioNs, size_t inicioAloc, bool primeira) {
+    double fimNs = agoraNs();
+    size_t fimAloc = atomic_load(&alocacoes);
+    m->ops = ops > 0 ? ops : 1;
+    m->ns_por_op = (fimNs - inicioNs) / (double)m->ops;
+    m->alocacoes_por_op = (double)(fimAloc - inicioAloc) / (double)m->ops;
+    m->pico_rss_kb = picoRSS();
+
+    if (cfg->json) {
+        printf("%s\n    {\"operacao\": \"%s\", \"ops\": %ld, \"ns_por_op\": %.1f, \"alocacoes_por_op\": %.2f, \"pico_rss_kb\": %ld}",
+               primeira ? "" : ",", m->operacao, m->ops, m->ns_por_op, m->alocacoes_por_op, m->pico_rss_kb);
+    } else {
+        printf("%s,%ld,%.1f,%.2f,%ld\n", m->operacao, m->ops, m->ns_por_op, m->alocacoes_por_op, m->pico_rss_kb);
+    }
+}
+
+/**
+ * @brief Lê as opções da linha de comandos (--nome=valor).
+ *
+ * @param argc Número de argumentos.
+ * @param argv Argumentos.
+ * @param cfg Parâmetros a preencher (já com os valores por omissão).
+ *
+ * @return true se todas as opções forem válidas.
+ */
+
+static bool lerOpcoes(int argc, char** argv, ConfigBench* cfg) {
+    for (int i = 1; i < argc; i++) {
+        const char* a = argv[i];
+        if (strcmp(a, "--json") == 0) cfg->json = true;
+        else if (strncmp(a, "--largura=", 10) == 0) cfg->largura = atoi(a + 10);
+        else if (strncmp(a, "--altura=", 9) == 0) cfg->altura = atoi(a + 9);
+        else if (strncmp(a, "--densidade=", 12) == 0) cfg->densidade = atof(a + 12);
+        else if (strncmp(a, "--frequencias=", 14) == 0) cfg->numFreqs = atoi(a + 14);
+        else if (strncmp(a, "--assimetria=", 13) == 0) cfg->assimetria = atof(a + 13);
+        else if (strncmp(a, "--repeticoes=", 13) == 0) cfg->repeticoes = atoi(a + 13);
+        else if (strncmp(a, "--semente=", 10) == 0) cfg->semente = (unsigned int)strtoul(a + 10, NULL, 10);
+        else return false;
+    }
+    return cfg->largura > 0 && cfg->altura > 0 && cfg->densidade >= 0.0 && cfg->densidade <= 1.0 &&
+           cfg->numFreqs >= 1 && cfg->numFreqs <= 62 && cfg->assimetria >= 0.0 && cfg->repeticoes > 0;
+}
+
+int main(int argc, char** argv)
+{
+    ConfigBench cfg = { 1000, 1000, 0.002, 16, 1.0, 100, 1, false };
+    if (!lerOpcoes(argc, argv, &cfg)) {
+        fprintf(stderr, "Uso: %s [--largura=N] [--altura=N] [--densidade=D] [--frequencias=N] "
+                        "[--assimetria=S] [--repeticoes=N] [--semente=N] [--json]\n", argv[0]);
+        return 1;
+    }
+
+    long antenas = gerarMapa(&cfg, BENCH_MAPA);
+    if (antenas < 0) {
+        fprintf(stderr, "Erro ao gerar o mapa sintético.\n");
+        return 1;
+    }
+
+    if (cfg.json) {
+        printf("{\n  \"largura\": %d, \"altura\": %d, \"densidade\": %g, \"frequencias\": %d, \"assimetria\": %g,"
+               " \"repeticoes\": %d, \"semente\": %u, \"antenas\": %ld,\n  \"resultados\": [",
+               cfg.largura, cfg.altura, cfg.densidade, cfg.numFreqs, cfg.assimetria, cfg.repeticoes, cfg.semente, antenas);
+    } else {
+        printf("operacao,ops,ns_por_op,alocacoes_por_op,pico_rss_kb\n");
+    }
+
+    Medicao m;
+    double t0;
+    size_t a0;
+    bool sucesso = false;
+
+    Grafo* vazio = CriarGrafo();
+    comecar(&m, "LerFicheiro", &t0, &a0);
+    Grafo* grafo = LerFicheiro(vazio, BENCH_MAPA, &sucesso);
+    terminar(&cfg, &m, 1, t0, a0, true);
+    if (!sucesso) {
+        fprintf(stderr, "Erro ao ler o mapa sintético.\n");
+        return 1;
+    }
+    DestruirGrafo(vazio, &sucesso);
+
+    // origens das travessias: antenas ao acaso, sempre as mesmas para a mesma semente
+    int numOrigens = cfg.repeticoes;
+    int* origens = malloc(2 * (size_t)numOrigens * sizeof(int));
+    if (!origens || grafo->num_vertices == 0) {
+        fprintf(stderr, "Mapa sem antenas.\n");
+        return 1;
+    }
+    for (int k = 0; k < numOrigens; k++) {
+        Vertice* v = grafo->vertices;
+        for (int passos = rand() % grafo->num_vertices; passos > 0; passos--) v = v->prox;
+        origens[2 * k] = v->x;
+        origens[2 * k + 1] = v->y;
+    }
+
+    comecar(&m, "deduzirNefasto", &t0, &a0);
+    deduzirNefasto(grafo);
+    terminar(&cfg, &m, 1, t0, a0, false);
+
+    comecar(&m, "ligarVerticesComMesmaFrequencia", &t0, &a0);
+    ligarVerticesComMesmaFrequencia(grafo);
+    terminar(&cfg, &m, 1, t0, a0, false);
+
+    comecar(&m, "bfs", &t0, &a0);
+    for (int k = 0; k < numOrigens; k++) bfs(grafo, origens[2 * k], origens[2 * k + 1]);
+    terminar(&cfg, &m, numOrigens, t0, a0, false);
+
+    comecar(&m, "dfs", &t0, &a0);
+    for (int k = 0; k < numOrigens; k++) dfs(grafo, origens[2 * k], origens[2 * k + 1]);
+    terminar(&cfg, &m, numOrigens, t0, a0, false);
+
+    comecar(&m, "gerarMatrizGrafo", &t0, &a0);
+    char* matriz = gerarMatrizGrafo(grafo);
+    terminar(&cfg, &m, 1, t0, a0, false);
+    free(matriz);
+
+    comecar(&m, "GuardarArestasBinario", &t0, &a0);
+    GuardarArestasBinario(grafo, BENCH_ARESTAS);
+    terminar(&cfg, &m, 1, t0, a0, false);
+
+    // as arestas são lidas para um grafo com os mesmos vértices e ainda sem arestas;
+    // lidas para o próprio grafo, seriam todas rejeitadas como repetidas
+    bool lido = false;
+    vazio = CriarGrafo();
+    Grafo* semArestas = LerFicheiro(vazio, BENCH_MAPA, &lido);
+    DestruirGrafo(vazio, &sucesso);
+    if (lido) {
+        deduzirNefasto(semArestas);
+        comecar(&m, "LerArestasBinario", &t0, &a0);
+        LerArestasBinario(semArestas, BENCH_ARESTAS);
+        terminar(&cfg, &m, 1, t0, a0, false);
+        DestruirGrafo(semArestas, &sucesso);
+    }
+
+    comecar(&m, "GuardarInstantaneo", &t0, &a0);
+    GuardarInstantaneo(grafo, BENCH_INSTANTANEO);
+    terminar(&cfg, &m, 1, t0, a0, false);
+
+    comecar(&m, "CarregarInstantaneo", &t0, &a0);
+    Grafo* carregado = CarregarInstantaneo(NULL, BENCH_INSTANTANEO, &sucesso);
+    terminar(&cfg, &m, 1, t0, a0, false);
+    if (carregado) DestruirGrafo(carregado, &sucesso);
+
+    comecar(&m, "AbrirInstantaneoCSR", &t0, &a0);
+    GrafoCSR* csr = AbrirInstantaneoCSR(BENCH_INSTANTANEO, VERIFICAR_INDICES);
+    terminar(&cfg, &m, 1, t0, a0, false);
+
+    if (csr) {
+        comecar(&m, "bfsCSR", &t0, &a0);
+        for (int k = 0; k < numOrigens; k++) bfsCSR(csr, origens[2 * k], origens[2 * k + 1]);
+        terminar(&cfg, &m, numOrigens, t0, a0, false);
+        csr = DestruirGrafoCSR(csr);
+    }
+
+    if (cfg.json) printf("\n  ]\n}\n");
+
+    free(origens);
+    DestruirGrafo(grafo, &sucesso);
+    remove(BENCH_MAPA);
+    remove(BENCH_ARESTAS);
+    remove(BENCH_INSTANTANEO);
+    return 0;
+}
@@ -11,9 +11,183 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <errno.h>
+#include <limits.h>
 #include <stdbool.h>
+#include <math.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#ifdef GRAFO_ESTATISTICAS
+#include <time.h>
+#endif
 #include "functest.h"
 
+// Instrumentação: com GRAFO_ESTATISTICAS definido (make OPCOES=-DGRAFO_ESTATISTICAS)
+// os contadores e tempos ficam em Grafo::estat; sem ele as macros não geram código.
+#ifdef GRAFO_ESTATISTICAS
+#define ESTAT_CONTAR(g, campo) ((g)->estat.campo++)
+#define ESTAT_POOL(p, campo) ((p)->campo++)
+#define ESTAT_INICIO(var) uint64_t var = relogioNs()
+#define ESTAT_FIM(g, fase, var) registarFase((g), (fase), (var))
+#else
+#define ESTAT_CONTAR(g, campo) ((void)0)
+#define ESTAT_POOL(p, campo) ((void)0)
+#define ESTAT_INICIO(var) ((void)0)
+#define ESTAT_FIM(g, fase, var) ((void)0)
+#endif
+
+#ifdef GRAFO_ESTATISTICAS
+/**
+ * @brief Lê o relógio monótono em nanossegundos.
+ * 
+ * @return uint64_t Instante atual (só serve para calcular diferenças).
+ */
+
+static uint64_t relogioNs(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint64_t)t.tv_sec * 1000000000u + (uint64_t)t.tv_nsec;
+}
+
+/**
+ * @brief Acumula no grafo o tempo de uma execução de uma fase.
+ * 
+ * @param g Ponteiro para o grafo.
+ * @param fase Fase executada.
+ * @param inicio Instante em que a fase começou (relogioNs).
+ */
+
+static void registarFase(Grafo* g, FaseGrafo fase, uint64_t inicio) {
+    g->estat.tempo_ns[fase] += relogioNs() - inicio;
+    g->estat.chamadas[fase]++;
+}
+#endif
+
+#define SLAB_CABECALHO ((sizeof(Slab) + 15) & ~(size_t)15) ///< Espaço do cabeçalho, mantendo os nós alinhados a 16 bytes
+#define SLAB_NOS_INICIAL 64       ///< Nós do primeiro slab de cada pool
+#define SLAB_NOS_MAXIMO 65536     ///< Limite para o crescimento do número de nós por slab
+
+/**
+ * @brief Inicializa um pool vazio para nós de um determinado tamanho.
+ * 
+ * @param p Pool a inicializar.
+ * @param tamanho Tamanho de cada nó em bytes.
+ */
+
+static void poolIniciar(PoolNos* p, size_t tamanho) {
+    if (tamanho < sizeof(void*)) tamanho = sizeof(void*); // o nó livre guarda o ponteiro da lista livre
+    p->tamanho_no = (tamanho + sizeof(void*) - 1) & ~(sizeof(void*) - 1);
+    p->nos_por_slab = SLAB_NOS_INICIAL;
+    p->slabs = NULL;
+    p->livres = NULL;
+    p->atual = NULL;
+    p->restantes = 0;
+    p->num_slabs = 0;
+#ifdef GRAFO_ESTATISTICAS
+    p->alocados = 0;
+    p->libertados = 0;
+#endif
+}
+
+/**
+ * @brief Aloca um novo slab com espaço para pelo menos n nós.
+ * 
+ * @param p Pool onde alocar.
+ * @param n Número mínimo de nós do slab.
+ * 
+ * @return true se o slab foi alocado, false caso contrário.
+ */
+
+static bool poolNovoSlab(PoolNos* p, size_t n) {
+    if (n < p->nos_por_slab) n = p->nos_por_slab;
+    Slab* s = malloc(SLAB_CABECALHO + n * p->tamanho_no);
+    if (!s) return false;
+    s->prox = p->slabs;
+    p->slabs = s;
+    p->num_slabs++;
+    p->atual = (char*)s + SLAB_CABECALHO;
+    p->restantes = n;
+    if (p->nos_por_slab < SLAB_NOS_MAXIMO) p->nos_por_slab *= 2; // slabs cada vez maiores = poucos slabs
+    return true;
+}
+
+/**
+ * @brief Garante que o pool consegue fornecer n nós sem voltar a chamar malloc.
+ * 
+ * Usado antes de inserções em massa, quando o número de nós já é conhecido.
+ * 
+ * @param p Pool a preparar.
+ * @param n Número de nós que vão ser pedidos.
+ * 
+ * @return true se há espaço, false se falhar a alocação.
+ */
+
+static bool poolReservar(PoolNos* p, size_t n) {
+    if (p->restantes >= n) return true;
+    return poolNovoSlab(p, n);
+}
+
+/**
+ * @brief Obtém um nó do pool: primeiro da lista livre, depois do slab atual.
+ * 
+ * @param p Pool de onde alocar.
+ * 
+ * @return void* Nó não inicializado, ou NULL se falhar a alocação de um novo slab.
+ */
+
+static void* poolAlocar(PoolNos* p) {
+    if (p->livres) { // reaproveita um nó libertado
+        void* no = p->livres;
+        p->livres = *(void**)no;
+        ESTAT_POOL(p, alocados);
+        return no;
+    }
+    if (!p->restantes && !poolNovoSlab(p, 0)) return NULL;
+    ESTAT_POOL(p, alocados);
+    void* no = p->atual;
+    p->atual += p->tamanho_no;
+    p->restantes--;
+    return no;
+}
+
+/**
+ * @brief Devolve um nó ao pool, colocando-o na lista livre.
+ * 
+ * @param p Pool a que o nó pertence.
+ * @param no Nó a devolver (pode ser NULL).
+ */
+
+static void poolLibertar(PoolNos* p, void* no) {
+    if (!no) return;
+    ESTAT_POOL(p, libertados);
+    *(void**)no = p->livres;
+    p->livres = no;
+}
+
+/**
+ * @brief Liberta todos os slabs de um pool de uma só vez.
+ * 
+ * O custo é proporcional ao número de slabs e não ao número de nós.
+ * 
+ * @param p Pool a destruir.
+ */
+
+static void poolDestruir(PoolNos* p) {
+    Slab* s = p->slabs;
+    while (s) {
+        Slab* temp = s;
+        s = s->prox;
+        free(temp);
+    }
+    poolIniciar(p, p->tamanho_no);
+}
+
 /**
  * @brief Cria um novo grafo e inicializa seus campos.
  * 
@@ -30,833 +204,5656 @@ Grafo* CriarGrafo() {
     if (!grafo) return NULL; //se nao houver espaço suficiente para criar o grafo retorna null
     grafo->vertices = NULL; // inicia a lista de vertices como vazia
     grafo->num_vertices = 0; // o grafo no inicio vai ter  0 vertices
+    grafo->proximo_id = 0; // os identificadores começam em 0
+    grafo->por_id = NULL; // a tabela de ids só é alocada no primeiro vértice
+    grafo->por_id_cap = 0;
+    grafo->ids_livres = NULL;
+    grafo->ids_livres_tam = 0;
+    grafo->ids_livres_cap = 0;
+    grafo->epoca = 0; // nenhuma travessia feita ainda
+    grafo->carimbo_lote = 0; // o carimbo 0 nunca é usado por inserirLote
+    grafo->percurso = NULL;
+    grafo->percurso_tam = 0;
+    grafo->percurso_cap = 0;
+    grafo->componentes_validas = true; // grafo vazio: não há componentes a manter
+    memset(grafo->grupos, 0, sizeof(grafo->grupos)); // grupos de frequência vazios
+    grafo->arestas_implicitas = false;
+    grafo->suprimidas = NULL; // a tabela de suprimidas só é alocada na primeira remoção implícita
+    grafo->suprimidas_cap = 0;
+    grafo->suprimidas_usadas = 0;
+    grafo->celulas = NULL; // grelha espacial vazia
+    grafo->celulas_cap = 0;
+    grafo->celulas_usadas = 0;
+    grafo->largura = 0; // dimensões só são conhecidas depois de LerFicheiro
+    grafo->altura = 0;
+    grafo->indice = NULL; // a tabela de coordenadas só é alocada no primeiro vértice
+    grafo->indice_cap = 0;
+    grafo->indice_usados = 0;
+    poolIniciar(&grafo->pool_vertices, sizeof(Vertice)); // os nós são alocados em slabs por grafo
+    poolIniciar(&grafo->pool_arestas, sizeof(Aresta));
+    poolIniciar(&grafo->pool_fila, sizeof(Fila));
+    grafo->fila_bfs.itens = NULL; // a fila da BFS só é alocada na primeira procura
+    grafo->fila_bfs.capacidade = 0;
+    grafo->fila_bfs.inicio = 0;
+    grafo->fila_bfs.tamanho = 0;
+    grafo->pilha_dfs = NULL; // a pilha da DFS também só é alocada quando é usada
+    grafo->pilha_dfs_cap = 0;
+#ifdef GRAFO_ESTATISTICAS
+    memset(&grafo->estat, 0, sizeof(grafo->estat)); // contadores a zero
+#endif
     return grafo; // retorna o grafo sem nada
 }
 
 /**
- * @brief Procura um vértice no grafo com coordenadas específicas.
+ * @brief Junta as coordenadas (x, y) numa única chave de 64 bits.
  * 
- * Percorre a lista de vértices do grafo procurando um vértice que tenha
- * as coordenadas (x, y) fornecidas como parâmetro.
- * 
- * @param g Ponteiro para o grafo onde a pesquisa será realizada.
- * @param x Coordenada X do vértice a procurar.
- * @param y Coordenada Y do vértice a procurar.
+ * @param x Coordenada X.
+ * @param y Coordenada Y.
  * 
- * @return Vertice* Ponteiro para o vértice encontrado ou NULL se não existir.
+ * @return uint64_t Chave com x nos 32 bits altos e y nos 32 bits baixos.
  */
 
-Vertice* ProcurarVertice(Grafo* g, int x, int y) {
-    Vertice* atual = g->vertices; //Inicia a procura a partir do primeiro vértice da lista ligada
-    while (atual) {
-        if (atual->x == x && atual->y == y) //atualiza as coordenadas da antena
-            return atual; //retorna para o vertice encontrado
-        atual = atual->prox; // se nao esta correta as coordenadas do vertice ele percorre a lista ate encontrar o que pretende
-    }
-    return NULL; // se nao encontrar o vertice anula a funcao ou seja n acontece
+static uint64_t chaveCoordenadas(int x, int y) {
+    return ((uint64_t)(uint32_t)x << 32) | (uint32_t)y;
 }
 
 /**
- * @brief Adiciona um novo vértice ao grafo com coordenadas e frequência especificadas.
+ * @brief Calcula a posição inicial de uma chave de coordenadas na tabela de dispersão.
  * 
- * Esta função cria um novo vértice, inicializa os seus campos com as coordenadas (x, y),
- * frequência e um ID único. O vértice é inserido no início da lista de vértices do grafo.
+ * Usa a função de mistura final do MurmurHash3 para espalhar bem coordenadas
+ * vizinhas (que só diferem nos bits baixos) por toda a tabela.
  * 
- * Antes de adicionar, verifica se já existe um vértice com as mesmas coordenadas.
- * Se existir, não adiciona e retorna o grafo original.
+ * @param chave Chave gerada por chaveCoordenadas.
+ * @param mascara Capacidade da tabela menos 1 (a capacidade é potência de 2).
  * 
- * @param g Ponteiro para o grafo onde o vértice será adicionado.
- * @param x Coordenada X do novo vértice.
- * @param y Coordenada Y do novo vértice.
- * @param freq Frequência associada ao vértice.
- * @param sucesso Ponteiro para booleano que indica se a adição foi bem-sucedida.
+ * @return size_t Posição inicial de pesquisa.
+ */
+
+static size_t dispersarChave(uint64_t chave, size_t mascara) {
+    chave ^= chave >> 33;
+    chave *= 0xff51afd7ed558ccdULL;
+    chave ^= chave >> 33;
+    chave *= 0xc4ceb53fe85a2ca6ULL;
+    chave ^= chave >> 33;
+    return (size_t)chave & mascara;
+}
+
+/**
+ * @brief Garante que o índice de coordenadas tem espaço para pelo menos n vértices.
  * 
- * @return Grafo* Ponteiro para o grafo atualizado.
+ * A tabela é mantida com fator de carga máximo de 1/2. Quando é preciso crescer,
+ * aloca uma tabela nova (potência de 2) e reinsere todos os vértices.
+ * 
+ * @param g Ponteiro para o grafo.
+ * @param n Número de vértices que a tabela tem de suportar.
+ * 
+ * @return true se houver espaço, false se falhar a alocação (a tabela antiga fica intacta).
  */
 
-Grafo* AdicionarVertice(Grafo* g, int x, int y, char freq, bool* sucesso) {
-    *sucesso = false; // o ponteiro sucesso é definio como false
-    if (ProcurarVertice(g, x, y)) return g; // Verifica se já existe um vértice com as mesmas coordenadas
+static bool indiceReservar(Grafo* g, size_t n) {
+    if (n * 2 <= g->indice_cap) return true; // ainda cabe sem passar metade da capacidade
 
-    Vertice* novo = malloc(sizeof(Vertice));// define otamanho alocado para o vertice
-    if (!novo) return g; // Se falhar a alocação, retorna o grafo sem alterações
+    size_t cap = g->indice_cap ? g->indice_cap : 16;
+    while (cap < n * 2) cap *= 2;
 
-    novo->id = g->num_vertices++;  // Atribui ID único
-    novo->x = x; // atualiza a cordenada x nova para o x do vertice criado
-    novo->y = y; // atualiza y
-    novo->freq = freq; 
-    novo->arestas = NULL;//o vertice criado (nasce) sem ligacao nenhumaou seja sem aresta
-    novo->prox = g->vertices; 
-    g->vertices = novo;   // Liga o novo vértice à lista de vértices do grafo (inserção no início da lista)
-    g->num_vertices++; // mais um vertice para o grafo
-    *sucesso = true; // vertice adicionado com sucesso
-    return g; // retorna o grafo com um vertice a mais
+    Vertice** nova = calloc(cap, sizeof(Vertice*));
+    if (!nova) return false;
+
+    for (size_t i = 0; i < g->indice_cap; i++) { // reinsere os vértices da tabela antiga
+        Vertice* v = g->indice[i];
+        if (!v) continue;
+        size_t pos = dispersarChave(chaveCoordenadas(v->x, v->y), cap - 1);
+        while (nova[pos]) pos = (pos + 1) & (cap - 1);
+        nova[pos] = v;
+    }
+
+    free(g->indice);
+    g->indice = nova;
+    g->indice_cap = cap;
+    return true;
 }
 
 /**
- * @brief Liberta a memória ocupada por uma lista ligada de arestas.
+ * @brief Insere um vértice no índice de coordenadas.
  * 
- * Esta função percorre a lista ligada de arestas, libertando a memória
- * de cada nó para evitar fugas de memória.
+ * Se as coordenadas já estiverem no índice, o vértice não é inserido. A
+ * verificação aproveita a própria sondagem, por isso quem carrega vértices em
+ * massa (CarregarInstantaneo) não precisa de chamar ProcurarVertice antes.
  * 
- * @param a Ponteiro para o início da lista ligada de arestas.
+ * @param g Ponteiro para o grafo.
+ * @param v Vértice a indexar.
  * 
- * @return bool Retorna true após libertar toda a lista.
+ * @return true se foi inserido, false se as coordenadas estiverem ocupadas ou falhar a alocação da tabela.
  */
 
-bool LibertarListaArestas(Aresta* a) {
-    while (a) { // Enquanto existir uma aresta na lista
-        Aresta* temp = a; // Guarda o ponteiro atual numa variável temporária
-        a = a->prox; // Avança para a próxima aresta da lista
-        free(temp);  // Liberta a memória da aresta atual
+static bool indiceInserir(Grafo* g, Vertice* v) {
+    if (!indiceReservar(g, g->indice_usados + 1)) return false;
+    size_t mascara = g->indice_cap - 1;
+    size_t pos = dispersarChave(chaveCoordenadas(v->x, v->y), mascara);
+    while (g->indice[pos]) { // sondagem linear até uma posição livre
+        if (g->indice[pos]->x == v->x && g->indice[pos]->y == v->y) return false; // coordenadas repetidas
+        pos = (pos + 1) & mascara;
     }
-    return true; // retorna bool se for uma funcao bem sucedida por ser booleana
+    g->indice[pos] = v;
+    g->indice_usados++;
+    return true;
 }
 
 /**
- * @brief Remove a aresta entre dois vértices no grafo.
+ * @brief Retira um vértice do índice de coordenadas.
  * 
- * Esta função procura os vértices de origem e destino no grafo e remove
- * as arestas que ligam esses dois vértices em ambas as direções (origem->destino e destino->origem).
- * Se os vértices não existirem, não faz alterações.
+ * Como a tabela usa sondagem linear, depois de libertar a posição os elementos
+ * seguintes do mesmo agrupamento são puxados para trás (backward shift), para
+ * não ser preciso usar marcas de "apagado".
  * 
- * @param g Ponteiro para o grafo onde a remoção será feita.
- * @param xOrig Coordenada X do vértice de origem.
- * @param yOrig Coordenada Y do vértice de origem.
- * @param xDest Coordenada X do vértice de destino.
- * @param yDest Coordenada Y do vértice de destino.
- * @param sucesso Ponteiro para variável booleana que indica se a remoção foi bem sucedida.
+ * @param g Ponteiro para o grafo.
+ * @param v Vértice a retirar.
  * 
- * @return Grafo* Ponteiro para o grafo atualizado.
+ * @return true se o vértice estava no índice, false caso contrário.
  */
 
-Grafo* RemoverAresta(Grafo* g, int xOrig, int yOrig, int xDest, int yDest, bool* sucesso) {
-    *sucesso = false;
-    Vertice* origem = ProcurarVertice(g, xOrig, yOrig); // procura o vertice inicial o primeiro
-    Vertice* destino = ProcurarVertice(g, xDest, yDest); // procura o vertice final ou a seguir ou seja os dois ligados
-    if (!origem || !destino) return g; // se nao encontrar nenhum vertice com as coordenadas pedidas devolve o grafo sem alteracoes
+static bool indiceRemover(Grafo* g, Vertice* v) {
+    if (!g->indice_cap) return false;
+    size_t mascara = g->indice_cap - 1;
+    size_t pos = dispersarChave(chaveCoordenadas(v->x, v->y), mascara);
+    while (g->indice[pos] && g->indice[pos] != v) pos = (pos + 1) & mascara;
+    if (!g->indice[pos]) return false;
 
-    
-    Aresta* atual = origem->arestas; // atual percorre a lista de arestas do vértice origem
-    Aresta* anterior = NULL; //guarda o ponteiro da aresta anterior
-    while (atual) { 
-        if (atual->destino == destino) { //Verificamos se esta aresta liga ao vértice de destino
-            if (anterior) anterior->prox = atual->prox; // Pedes à aresta anterior para ignorar a atual e ligar-se diretamente à próxima (atual->prox).
-            else origem->arestas = atual->prox; // Resultado: a lista continua, mas sem o primeiro elemento
-            free(atual); //liberta a memoria da aresta  
-            *sucesso = true; // 
-            break; //Paramos o ciclo porque já removemos a aresta.
-        }
-        //Avançamos na lista, se ainda não encontramos a ligação.
-        anterior = atual;
-        atual = atual->prox;
-    }
-
-    
-    atual = destino->arestas; //Agora percorremos a lista de arestas do vértice destino
-    anterior = NULL; // guarda o ponteiro da aresta anterior
-    while (atual) {
-        if (atual->destino == origem) {
-            if (anterior) anterior->prox = atual->prox; // o mesmo processo so q ao contrario
-            else destino->arestas = atual->prox;
-            free(atual);
-            *sucesso = true; 
-            break;
+    size_t livre = pos;
+    size_t j = pos;
+    while (true) {
+        j = (j + 1) & mascara;
+        Vertice* w = g->indice[j];
+        if (!w) break;
+        size_t casa = dispersarChave(chaveCoordenadas(w->x, w->y), mascara);
+        // w só pode recuar para "livre" se a sua posição de origem não estiver entre livre e j (circularmente)
+        bool entre = (livre <= j) ? (casa > livre && casa <= j) : (casa > livre || casa <= j);
+        if (!entre) {
+            g->indice[livre] = w;
+            livre = j;
         }
-        anterior = atual;
-        atual = atual->prox;
     }
-
-    return g;
+    g->indice[livre] = NULL;
+    g->indice_usados--;
+    return true;
 }
 
 /**
- * @brief Remove um vértice do grafo com todas as suas ligações.
+ * @brief Garante que a tabela de ids tem posições para os ids 0 a n - 1.
  * 
- * Esta função procura o vértice no grafo com as coordenadas fornecidas (x, y)
- * e remove-o da lista de vértices. Antes de remover, elimina todas as arestas 
- * que apontam para esse vértice, garantindo que não fiquem ligações pendentes.
- * Se o vértice não existir, o grafo permanece inalterado.
+ * A tabela cresce para o dobro (no mínimo 16 posições) e as posições novas
+ * ficam a NULL.
  * 
- * @param g Ponteiro para o grafo onde será feita a remoção.
- * @param x Coordenada X do vértice a remover.
- * @param y Coordenada Y do vértice a remover.
- * @param sucesso Ponteiro para variável booleana que indica se a remoção foi bem sucedida.
+ * @param g Ponteiro para o grafo.
+ * @param n Número de ids que a tabela tem de suportar.
  * 
- * @return Grafo* Ponteiro para o grafo atualizado.
+ * @return true se houver espaço, false se falhar a alocação (a tabela antiga fica intacta).
  */
 
-Grafo* RemoverVertice(Grafo* g, int x, int y, bool* sucesso) {
-    *sucesso = false;
-    Vertice *atual = g->vertices, *anterior = NULL; //cria o ponteiro atual que armazena o 1 vertice do grafo,c ponteiro anterior é criado para que nao se perca nada da lista
-    while (atual) {
-        if (atual->x == x && atual->y == y) { // quando sao digitadas as coordenadas de um vertice
-            
-            Vertice* v = g->vertices; // cria um ponteiro que toma o valor do primeiro vertice
-            while (v) {
-                bool dummy;
-                RemoverAresta(g, v->x, v->y, x, y, &dummy); // remove a aresta que foi desejada
-                v = v->prox; // atualiza a lista e o primeiro vertice sera o proximo
-            }
-            LibertarListaArestas(atual->arestas); // liberta a primeira aresta
-            if (anterior) anterior->prox = atual->prox; // remove o vertice no meio e Se existe um nó anterior, ele "pula" o nó atual, apontando direto para o próximo.
-            else g->vertices = atual->prox; //Quando o vértice a remover é o primeiro da lista, atualizamos o ponteiro inicial da lista para o próximo vértice.
-            free(atual); // liberta a memoria do vertice removido
-            g->num_vertices--; // tira o numero de verticess removido
-            *sucesso = true;
-            break; //para se removeu
-        }
-        anterior = atual;
-        atual = atual->prox; //percorre a lista sem perder o vertice anterior
-    }
-    return g;//retorna o grafo se nao encontrar o vertice pretendido
+static bool idsReservar(Grafo* g, int n) {
+    if (n <= g->por_id_cap) return true;
+    int cap = g->por_id_cap ? g->por_id_cap : 16;
+    while (cap < n) cap = cap > INT32_MAX / 2 ? INT32_MAX : cap * 2;
+
+    Vertice** nova = realloc(g->por_id, (size_t)cap * sizeof(Vertice*));
+    if (!nova) return false;
+    memset(nova + g->por_id_cap, 0, (size_t)(cap - g->por_id_cap) * sizeof(Vertice*));
+    g->por_id = nova;
+    g->por_id_cap = cap;
+    return true;
 }
 
 /**
- * @brief Adiciona uma aresta entre dois vértices no grafo.
- * 
- * Esta função cria uma ligação direcionada do vértice de origem para o vértice 
- * de destino, representando uma aresta na estrutura do grafo. Antes de adicionar,
- * verifica se ambos os vértices existem e se a aresta já não está presente, 
- * evitando duplicações.
+ * @brief Dá um id a um vértice novo e regista-o na tabela de ids.
  * 
- * @param g Ponteiro para o grafo onde a aresta será adicionada.
- * @param xOrig Coordenada X do vértice de origem.
- * @param yOrig Coordenada Y do vértice de origem.
- * @param xDest Coordenada X do vértice de destino.
- * @param yDest Coordenada Y do vértice de destino.
- * @param sucesso Ponteiro para variável booleana que indica se a aresta foi adicionada com sucesso.
+ * Usa primeiro o último id libertado por RemoverVertice e só depois proximo_id.
+ * Quem chama já reservou a tabela com idsReservar(g, g->proximo_id + 1).
  * 
- * @return Grafo* Ponteiro para o grafo atualizado.
+ * @param g Ponteiro para o grafo.
+ * @param v Vértice novo.
  */
 
-Grafo* AdicionarAresta(Grafo* g, int xOrig, int yOrig, int xDest, int yDest, bool* sucesso) {
-    *sucesso = false;
-    Vertice* origem = ProcurarVertice(g, xOrig, yOrig); // procura o vertice de origem
-    Vertice* destino = ProcurarVertice(g, xDest, yDest); // procura o destino
-    if (!origem || !destino) return g; // se nao encontrar retorna o grafo
+static void idAtribuir(Grafo* g, Vertice* v) {
+    v->id = g->ids_livres_tam > 0 ? g->ids_livres[--g->ids_livres_tam] : g->proximo_id++;
+    g->por_id[v->id] = v;
+}
 
-    Aresta* a = origem->arestas; // cria a variavel a q armazena a primeira aresta
-    while (a) {
-        if (a->destino == destino) return g; //se a aresta destino ja existir retorna o grafo
-        a = a->prox; // percorre a lista
-    }
+/**
+ * @brief Retira um vértice da tabela de ids e guarda o seu id para ser reutilizado.
+ * 
+ * Se faltar memória para a pilha de ids livres, o id simplesmente não é reutilizado.
+ * 
+ * @param g Ponteiro para o grafo.
+ * @param v Vértice a retirar.
+ */
 
-    Aresta* nova = malloc(sizeof(Aresta)); // cria momoria para nova aresta
-    if (!nova) return g; // se nao houver espaço retorna o grafo
-    nova->destino = destino;// Define o destino da nova aresta
-    nova->prox = origem->arestas; // O novo nó 'nova' vai apontar para a primeira aresta atual do vértice 'origem' (inserção no início da lista)
-    origem->arestas = nova; //Agora, o vértice 'origem' passa a ter 'nova' como a primeira aresta da sua lista.
-    *sucesso = true;
-    return g;
+static void idLibertar(Grafo* g, Vertice* v) {
+    g->por_id[v->id] = NULL;
+    if (g->ids_livres_tam == g->ids_livres_cap) {
+        int cap = g->ids_livres_cap ? g->ids_livres_cap * 2 : 16;
+        int* maior = realloc(g->ids_livres, (size_t)cap * sizeof(int));
+        if (!maior) return;
+        g->ids_livres = maior;
+        g->ids_livres_cap = cap;
+    }
+    g->ids_livres[g->ids_livres_tam++] = v->id;
 }
 
 /**
- * @brief Liberta toda a memória associada ao grafo e aos seus vértices.
+ * @brief Reconstrói a tabela de ids e a pilha de ids livres a partir dos ids dos vértices.
  * 
- * Esta função percorre todos os vértices do grafo, libertando as listas de arestas 
- * associadas a cada vértice, e depois liberta a memória dos próprios vértices. 
- * Finalmente, liberta a memória da estrutura do grafo.
+ * Usado quando os ids vêm de fora (CarregarInstantaneo). Os ids por usar abaixo de
+ * proximoId ficam livres, com os menores a serem reutilizados primeiro.
  * 
- * @param g Ponteiro para o grafo a ser destruído.
- * @param sucesso Ponteiro para variável booleana que indica se a operação foi bem-sucedida.
+ * @param g Ponteiro para o grafo.
+ * @param proximoId Valor de proximo_id a usar.
  * 
- * @return NULL Retorna NULL para facilitar a atribuição do ponteiro do grafo a NULL após a destruição.
+ * @return true se a tabela foi reconstruída, false se algum id for repetido ou
+ *         estiver fora de [0, proximoId), ou se falhar a alocação.
  */
 
-Grafo* DestruirGrafo(Grafo* g, bool* sucesso) {
-    *sucesso = false;
-    Vertice* atual = g->vertices; // o ponteiro atual aponta para o primeiro vertice
-    while (atual) {
-        Vertice* temp = atual; // Cria um ponteiro temp para guardar o vértice atual, para que possamos liberar sua memória depois.
-        LibertarListaArestas(temp->arestas); // Liberta todas as arestas ligadas ao vértice apontado por temp
-        atual = atual->prox;// Atualiza atual para apontar para o próximo vértice da lista
-        free(temp); // liberta a memoria do primeiro vertice
+static bool idsReconstruir(Grafo* g, int proximoId) {
+    if (proximoId < g->num_vertices || !idsReservar(g, proximoId)) return false;
+    int livres = proximoId - g->num_vertices;
+    if (livres > g->ids_livres_cap) {
+        int* maior = realloc(g->ids_livres, (size_t)livres * sizeof(int));
+        if (!maior) return false;
+        g->ids_livres = maior;
+        g->ids_livres_cap = livres;
     }
-    free(g); // elimina a memoria do grafo removido
-    *sucesso = true;
-    return NULL; //retorna o grafo sem nada
+    memset(g->por_id, 0, (size_t)g->por_id_cap * sizeof(Vertice*));
+    for (Vertice* v = g->vertices; v != NULL; v = v->prox) {
+        if (v->id < 0 || v->id >= proximoId || g->por_id[v->id]) return false;
+        g->por_id[v->id] = v;
+    }
+    g->ids_livres_tam = 0;
+    for (int id = proximoId - 1; id >= 0; id--) { // do maior para o menor: o topo da pilha é o menor
+        if (!g->por_id[id]) g->ids_livres[g->ids_livres_tam++] = id;
+    }
+    g->proximo_id = proximoId;
+    return true;
 }
 
+/// @brief Conjunto de coordenadas (tabela de dispersão com sondagem linear), usado internamente
+typedef struct ConjuntoCoord {
+    uint64_t* chaves;          ///< Chaves (x, y) guardadas
+    unsigned char* usado;      ///< 1 se a posição correspondente estiver ocupada
+    size_t cap;                ///< Capacidade (potência de 2)
+    size_t tamanho;            ///< Número de chaves guardadas
+} ConjuntoCoord;
+
 /**
- * @brief Lê um grafo a partir de um ficheiro de texto.
+ * @brief Inicializa um conjunto de coordenadas com espaço para cerca de n elementos.
  * 
- * Esta função abre um ficheiro cujo nome é fornecido e lê linha a linha,
- * criando vértices no grafo para cada caractere diferente de '.'.
- * As coordenadas x e y são usadas para definir a posição do vértice.
- * O grafo é criado do zero dentro da função.
- * 
- * @param g Ponteiro para o grafo atual (será substituído pelo novo grafo criado).
- * @param nomeFicheiro Nome do ficheiro de texto a ler.
- * @param sucesso Ponteiro para variável booleana que indica se a leitura foi bem-sucedida.
+ * @param c Conjunto a inicializar.
+ * @param n Número de elementos esperado.
  * 
- * @return Grafo* Ponteiro para o grafo lido do ficheiro (novo grafo criado).
+ * @return true se a alocação foi feita, false caso contrário.
  */
 
-Grafo* LerFicheiro(Grafo* g, const char* nomeFicheiro, bool* sucesso) {
-    FILE* f = fopen(nomeFicheiro, "r"); // Abre o ficheiro para leitura.
-    if (!f) { // Se não foi possível abrir o ficheiro
-        *sucesso = false; // nao ha sucesso
-        return g; // retorna o grafo como estava
+static bool conjuntoIniciar(ConjuntoCoord* c, size_t n) {
+    size_t cap = 16;
+    while (cap < n * 2) cap *= 2;
+    c->chaves = malloc(cap * sizeof(uint64_t));
+    c->usado = calloc(cap, 1);
+    c->cap = cap;
+    c->tamanho = 0;
+    if (!c->chaves || !c->usado) {
+        free(c->chaves);
+        free(c->usado);
+        c->chaves = NULL;
+        c->usado = NULL;
+        return false;
     }
+    return true;
+}
 
-    g = CriarGrafo(); // cria grafo sem nada
-    int x = 0, y = 0; // cria variaveis x e y com valor inicial de 0
-    char c; // Declara variável para armazenar cada carácter lido do ficheiro
+/**
+ * @brief Liberta a memória de um conjunto de coordenadas.
+ * 
+ * @param c Conjunto a libertar.
+ */
 
-    while ((c = fgetc(f)) != EOF) { // while lê cada carácter até ao fim do ficheiro
-        if (c == '\n') { // se vai para a linha de baixo
-            y++; // Incrementa y para indicar que passámos para a próxima linha
-            x = 0; // Reinicia x para zero no início de cada nova linha
-        } else {
-            if (c != '.') { // se no ficheiro nao for o . indica que será adicionado um vertice 
-                bool adicionado;
-                g = AdicionarVertice(g, x, y, c, &adicionado);//está a adicionar um vértice nas coordenadas (x, y) com o valor c
-            }
-            x++; // soma 1 x a cada vez que se move para a direita e ao chegar ao fim aciona o y++ e recomeça o x denovo
+static void conjuntoLibertar(ConjuntoCoord* c) {
+    free(c->chaves);
+    free(c->usado);
+    c->chaves = NULL;
+    c->usado = NULL;
+    c->cap = 0;
+    c->tamanho = 0;
+}
+
+/**
+ * @brief Insere uma chave no conjunto, duplicando a capacidade quando passa de metade.
+ * 
+ * @param c Conjunto onde inserir.
+ * @param chave Chave gerada por chaveCoordenadas.
+ * 
+ * @return int 1 se a chave é nova, 0 se já existia, -1 se falhar a alocação.
+ */
+
+static int conjuntoInserir(ConjuntoCoord* c, uint64_t chave) {
+    if ((c->tamanho + 1) * 2 > c->cap) { // cresce antes de ficar demasiado cheio
+        ConjuntoCoord maior;
+        if (!conjuntoIniciar(&maior, c->cap)) return -1;
+        for (size_t i = 0; i < c->cap; i++) {
+            if (!c->usado[i]) continue;
+            size_t pos = dispersarChave(c->chaves[i], maior.cap - 1);
+            while (maior.usado[pos]) pos = (pos + 1) & (maior.cap - 1);
+            maior.chaves[pos] = c->chaves[i];
+            maior.usado[pos] = 1;
         }
+        maior.tamanho = c->tamanho;
+        conjuntoLibertar(c);
+        *c = maior;
     }
 
-    *sucesso = true; //O ficheiro foi lido com sucesso
-    fclose(f); // fecha o ficheiro 
-    return g;
+    size_t mascara = c->cap - 1;
+    size_t pos = dispersarChave(chave, mascara);
+    while (c->usado[pos]) {
+        if (c->chaves[pos] == chave) return 0;
+        pos = (pos + 1) & mascara;
+    }
+    c->chaves[pos] = chave;
+    c->usado[pos] = 1;
+    c->tamanho++;
+    return 1;
 }
 
 /**
- * @brief Deduz e adiciona vértices "nefastos" num grafo baseado em reflexões.
- * 
- * Esta função percorre todos os pares de vértices do grafo e verifica se têm a mesma
- * frequência e não são o caractere '#'. Para cada par, calcula as posições espelhadas
- * dos vértices relativamente ao outro, e tenta adicionar novos vértices nessas posições
- * com frequência '#', que representam vértices "nefastos".
+ * @brief Procura um vértice no grafo com coordenadas específicas.
  * 
- * Se algum vértice nefasto for adicionado com sucesso, a função retorna true,
- * indicando que o grafo foi modificado.
+ * Consulta o índice de coordenadas do grafo (tabela de dispersão com chave (x, y)),
+ * pelo que a procura tem custo esperado O(1) em vez de percorrer a lista de vértices.
  * 
- * @param g Ponteiro para o grafo onde serão adicionados os vértices nefastos.
+ * @param g Ponteiro para o grafo onde a pesquisa será realizada.
+ * @param x Coordenada X do vértice a procurar.
+ * @param y Coordenada Y do vértice a procurar.
  * 
- * @return bool true se pelo menos um vértice nefasto foi adicionado; false caso contrário.
+ * @return Vertice* Ponteiro para o vértice encontrado ou NULL se não existir.
  */
 
-bool deduzirNefasto(Grafo* g) {
-    bool modificou = false;
-    for (Vertice* v1 = g->vertices; v1 != NULL; v1 = v1->prox) { //Começa um ciclo for que percorre todos os vértices do grafo, usando o ponteiro v1 
-        for (Vertice* v2 = g->vertices; v2 != NULL; v2 = v2->prox) { // Isto faz com que cada vértice seja comparado com todos os outros (incluindo ele mesmo).
-            if (v1 == v2) continue; // Se v1 e v2 apontam para o mesmo vértice, ignora essa iteração do ciclo (passa para o próximo v2
-            if (v1->freq == v2->freq && v1->freq != '#') { //Verifica se os dois vértices têm a mesma frequência (freq) e essa frequência não é o carácter '#'
-               //Calcula as coordenadas "espelhadas" do vértice v2 relativamente a v1. É como refletir v2 em torno de v1.
-                int x_espelho1 = 2 * v1->x - v2->x;
-                int y_espelho1 = 2 * v1->y - v2->y;
-
-                //Faz o mesmo cálculo inverso, espelhando v1 relativamente a v2.
-                int x_espelho2 = 2 * v2->x - v1->x;
-                int y_espelho2 = 2 * v2->y - v1->y;
-
-                bool sucesso;
-
-                if (x_espelho1 >= 0 && y_espelho1 >= 0) { //Se as coordenadas espelhadas são válidas (não negativas)
-                    AdicionarVertice(g, x_espelho1, y_espelho1, '#', &sucesso); //tenta adicionar um novo vértice com frequência '#' (marcador) nessas coordenadas. 
-                    if (sucesso) modificou = true;//Se for adicionado com sucesso
-                }
-
-                if (x_espelho2 >= 0 && y_espelho2 >= 0) { // a mesma coisa para o segundo espelhamento
-                    AdicionarVertice(g, x_espelho2, y_espelho2, '#', &sucesso);
-                    if (sucesso) modificou = true;
-                }
-            }
-        }
+Vertice* ProcurarVertice(Grafo* g, int x, int y) {
+    ESTAT_CONTAR(g, procuras);
+    if (!g->indice_cap) return NULL; // grafo ainda sem vértices
+    size_t mascara = g->indice_cap - 1;
+    size_t pos = dispersarChave(chaveCoordenadas(x, y), mascara); // posição onde a procura começa
+    while (g->indice[pos]) {
+        ESTAT_CONTAR(g, sondagens);
+        Vertice* atual = g->indice[pos];
+        if (atual->x == x && atual->y == y)
+            return atual; //retorna para o vertice encontrado
+        pos = (pos + 1) & mascara; // sondagem linear: passa para a posição seguinte
     }
-    return modificou;// ermina os ciclos e retorna modificou, que indica se alguma modificação (adição) foi feita ao grafo.
+    return NULL; // chegou a uma posição vazia, o vértice não existe
 }
 
 /**
- * @brief Lista todas as antenas do grafo e as suas conexões (arestas).
+ * @brief Encontra a raiz da árvore union-find de um vértice.
  * 
- * Esta função percorre todos os vértices do grafo, imprime as coordenadas e a frequência
- * de cada antena, seguido das antenas ligadas a ela (arestas). Além disso, conta o número
- * total de antenas existentes no grafo.
+ * Usa compressão de caminho por divisão a meio (cada vértice passa a apontar
+ * para o avô), o que mantém as árvores quase planas sem recursão.
  * 
- * @param g Ponteiro para o grafo contendo as antenas.
- * @param contador Ponteiro para um inteiro onde será armazenado o número total de antenas.
+ * @param v Vértice.
  * 
- * @return Vertice* Ponteiro para o primeiro vértice da lista do grafo.
+ * @return Vertice* Raiz da componente de v.
  */
 
- Vertice* listarAntenas(Grafo* g, int* contador){
-    if (!g || !contador) return NULL; // o grafo ou o ponteiro contador não foram passados (são NULL).
-
-    *contador = 0; // o contador começa a zero
-    Vertice* v = g->vertices; // o ponteiro v criado aponta para o primeiro vertice
-    while (v) {
-        printf("Antena (%d, %d) [%c] -> ", v->x, v->y, v->freq); //exibe as coordenadas e frequência da antena atual
-        Aresta* a = v->arestas; // o ponteiro a tem o valor da primeira aresta
-        while (a) {
-            printf("%c(%d, %d) ", a->destino->freq, a->destino->x, a->destino->y); // exibe todas as antenas destino das arestas do vértice atual.
-            a = a->prox; // percorre a lista de arestas
-        }
-        printf("\n");
-        (*contador)++; // conta uma antena visitada
-        v = v->prox;//percorre a lista de vertices
+static Vertice* ufRaiz(Vertice* v) {
+    while (v->uf_pai != v) {
+        v->uf_pai = v->uf_pai->uf_pai;
+        v = v->uf_pai;
     }
-
-    return g->vertices; //retorna o ponteiro para o primeiro vértice da lista de vértices.
+    return v;
 }
 
 /**
- * @brief Guarda o grafo num ficheiro de texto.
- *
- * Esta função cria uma matriz bidimensional representando as antenas
+ * @brief Junta as componentes de dois vértices (união por rank).
+ * 
+ * Só pode ser chamada com Grafo::componentes_validas a true: depois de uma
+ * remoção a floresta pode apontar para vértices que já voltaram ao pool, e as
+ * componentes são de qualquer forma refeitas na consulta seguinte.
+ * 
+ * @param a Primeiro vértice.
+ * @param b Segundo vértice.
+ */
+
+static void ufUnir(Vertice* a, Vertice* b) {
+    a = ufRaiz(a);
+    b = ufRaiz(b);
+    if (a == b) return;
+    if (a->uf_rank < b->uf_rank) { // a árvore mais baixa fica debaixo da mais alta
+        Vertice* t = a;
+        a = b;
+        b = t;
+    }
+    b->uf_pai = a;
+    a->uf_tamanho += b->uf_tamanho;
+    if (a->uf_rank == b->uf_rank) a->uf_rank++;
+}
+
+/**
+ * @brief Indica se uma frequência dá origem a ligações entre antenas ('#' e '.' não dão).
+ * 
+ * @param freq Frequência.
+ * 
+ * @return true se antenas com esta frequência se ligam entre si.
+ */
+
+static bool frequenciaLigavel(char freq) {
+    return freq != '#' && freq != '.';
+}
+
+/**
+ * @brief Indica se a ligação a -> b é implícita (modo implícito e mesma frequência).
+ * 
+ * @param g Ponteiro para o grafo.
+ * @param a Vértice de origem.
+ * @param b Vértice de destino.
+ * 
+ * @return true se a ligação é dada pelo grupo de frequência e não por uma aresta guardada.
+ */
+
+static bool ligacaoImplicita(Grafo* g, Vertice* a, Vertice* b) {
+    return g->arestas_implicitas && a != b && a->freq == b->freq && frequenciaLigavel(a->freq);
+}
+
+/**
+ * @brief Indica se uma lista de arestas tem alguma aresta para o destino dado.
+ * 
+ * @param lista Primeira aresta da lista.
+ * @param destino Vértice procurado.
+ * 
+ * @return true se existir.
+ */
+
+static bool listaContem(Aresta* lista, Vertice* destino) {
+    for (; lista != NULL; lista = lista->prox) {
+        ESTAT_CONTAR(destino->dono, nos_percorridos);
+        if (lista->destino == destino) return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Acrescenta uma aresta para destino no início de uma lista.
+ * 
+ * @param lista Ponteiro para o início da lista.
+ * @param destino Vértice de destino.
+ * @param pool Pool de onde vem o nó.
+ * 
+ * @return true se foi acrescentada, false se falhar a alocação.
+ */
+
+static bool juntarALista(Aresta** lista, Vertice* destino, PoolNos* pool) {
+    Aresta* nova = poolAlocar(pool);
+    if (!nova) return false;
+    nova->destino = destino;
+    nova->prox = *lista;
+    nova->ant = NULL;
+    nova->par = NULL;
+    if (*lista) (*lista)->ant = nova;
+    *lista = nova;
+    return true;
+}
+
+/**
+ * @brief Tira um nó de uma lista em O(1) (a lista é duplamente ligada) e devolve-o ao pool.
+ * 
+ * @param lista Ponteiro para o início da lista a que o nó pertence.
+ * @param a Nó a tirar.
+ * @param pool Pool a que o nó pertence.
+ */
+
+static void desligarNo(Aresta** lista, Aresta* a, PoolNos* pool) {
+    if (a->ant) a->ant->prox = a->prox;
+    else *lista = a->prox;
+    if (a->prox) a->prox->ant = a->ant;
+    poolLibertar(pool, a);
+}
+
+/**
+ * @brief Procura numa lista a primeira aresta para destino.
+ * 
+ * @param lista Primeira aresta da lista.
+ * @param destino Vértice procurado.
+ * 
+ * @return Aresta* A aresta, ou NULL se não existir.
+ */
+
+static Aresta* procurarNaLista(Aresta* lista, Vertice* destino) {
+    for (; lista != NULL; lista = lista->prox) {
+        ESTAT_CONTAR(destino->dono, nos_percorridos);
+        if (lista->destino == destino) return lista;
+    }
+    return NULL;
+}
+
+/**
+ * @brief Acrescenta a aresta origem -> destino e a entrada correspondente no destino.
+ * 
+ * A aresta e a entrada apontam uma para a outra (campo par), para que qualquer
+ * uma possa ser retirada da outra lista em O(1).
+ * 
+ * @param g Ponteiro para o grafo.
+ * @param origem Vértice de origem.
+ * @param destino Vértice de destino.
+ * 
+ * @return true se foi acrescentada, false se falhar a alocação (e nada muda).
+ */
+
+static bool acrescentarAresta(Grafo* g, Vertice* origem, Vertice* destino) {
+    if (!juntarALista(&origem->arestas, destino, &g->pool_arestas)) return false;
+    if (!juntarALista(&destino->entradas, origem, &g->pool_arestas)) {
+        desligarNo(&origem->arestas, origem->arestas, &g->pool_arestas);
+        return false;
+    }
+    origem->arestas->par = destino->entradas;
+    destino->entradas->par = origem->arestas;
+    return true;
+}
+
+/**
+ * @brief Retira a aresta origem -> destino e a entrada correspondente no destino.
+ * 
+ * Só a lista da origem é percorrida; a entrada sai pelo campo par em O(1).
+ * 
+ * @param g Ponteiro para o grafo.
+ * @param origem Vértice de origem.
+ * @param destino Vértice de destino.
+ * 
+ * @return true se a aresta existia.
+ */
+
+static bool retirarAresta(Grafo* g, Vertice* origem, Vertice* destino) {
+    Aresta* a = procurarNaLista(origem->arestas, destino);
+    if (!a) return false;
+    desligarNo(&destino->entradas, a->par, &g->pool_arestas);
+    desligarNo(&origem->arestas, a, &g->pool_arestas);
+    return true;
+}
+
+/**
+ * @brief Junta os endereços de origem e destino de uma ligação numa chave de 64 bits.
+ * 
+ * @param origem Vértice de origem.
+ * @param destino Vértice de destino.
+ * 
+ * @return uint64_t Chave a espalhar com dispersarChave.
+ */
+
+static uint64_t chaveLigacao(const Vertice* origem, const Vertice* destino) {
+    return ((uint64_t)(uintptr_t)origem * 0x9e3779b97f4a7c15ULL) ^ (uint64_t)(uintptr_t)destino;
+}
+
+/**
+ * @brief Garante que a tabela de ligações suprimidas tem espaço para pelo menos n ligações.
+ * 
+ * Tal como o índice de coordenadas, a tabela é mantida com fator de carga
+ * máximo de 1/2 e reconstruída numa capacidade maior quando é preciso.
+ * 
+ * @param g Ponteiro para o grafo.
+ * @param n Número de ligações que a tabela tem de suportar.
+ * 
+ * @return true se houver espaço, false se falhar a alocação (a tabela antiga fica intacta).
+ */
+
+static bool suprimidasReservar(Grafo* g, size_t n) {
+    if (n * 2 <= g->suprimidas_cap) return true;
+
+    size_t cap = g->suprimidas_cap ? g->suprimidas_cap : 16;
+    while (cap < n * 2) cap *= 2;
+
+    LigacaoSuprimida* nova = calloc(cap, sizeof(LigacaoSuprimida));
+    if (!nova) return false;
+
+    for (size_t i = 0; i < g->suprimidas_cap; i++) { // reinsere as ligações da tabela antiga
+        LigacaoSuprimida l = g->suprimidas[i];
+        if (!l.origem) continue;
+        size_t pos = dispersarChave(chaveLigacao(l.origem, l.no->destino), cap - 1);
+        while (nova[pos].origem) pos = (pos + 1) & (cap - 1);
+        nova[pos] = l;
+    }
+
+    free(g->suprimidas);
+    g->suprimidas = nova;
+    g->suprimidas_cap = cap;
+    return true;
+}
+
+/**
+ * @brief Procura a ligação suprimida origem -> destino na tabela.
+ * 
+ * @param g Ponteiro para o grafo.
+ * @param origem Vértice de origem.
+ * @param destino Vértice de destino.
+ * 
+ * @return LigacaoSuprimida* A posição da ligação, ou NULL se não estiver suprimida.
+ */
+
+static LigacaoSuprimida* procurarSuprimida(Grafo* g, const Vertice* origem, const Vertice* destino) {
+    if (g->suprimidas_usadas == 0) return NULL;
+    size_t mascara = g->suprimidas_cap - 1;
+    size_t pos = dispersarChave(chaveLigacao(origem, destino), mascara);
+    while (g->suprimidas[pos].origem) {
+        if (g->suprimidas[pos].origem == origem && g->suprimidas[pos].no->destino == destino) return &g->suprimidas[pos];
+        pos = (pos + 1) & mascara;
+    }
+    return NULL;
+}
+
+/**
+ * @brief Indica se a ligação implícita origem -> destino foi removida, em O(1).
+ * 
+ * @param g Ponteiro para o grafo.
+ * @param origem Vértice de origem.
+ * @param destino Vértice de destino.
+ * 
+ * @return true se a ligação está suprimida.
+ */
+
+static bool ligacaoSuprimida(Grafo* g, const Vertice* origem, const Vertice* destino) {
+    return origem->suprimidas && procurarSuprimida(g, origem, destino) != NULL;
+}
+
+/**
+ * @brief Tira uma posição da tabela de ligações suprimidas (backward shift, como indiceRemover).
+ * 
+ * O nó da lista de suprimidas da origem não é tocado.
+ * 
+ * @param g Ponteiro para o grafo.
+ * @param l Posição ocupada da tabela.
+ */
+
+static void esquecerSuprimida(Grafo* g, LigacaoSuprimida* l) {
+    size_t mascara = g->suprimidas_cap - 1;
+    size_t livre = (size_t)(l - g->suprimidas);
+    size_t j = livre;
+    while (true) {
+        j = (j + 1) & mascara;
+        LigacaoSuprimida w = g->suprimidas[j];
+        if (!w.origem) break;
+        size_t casa = dispersarChave(chaveLigacao(w.origem, w.no->destino), mascara);
+        bool entre = (livre <= j) ? (casa > livre && casa <= j) : (casa > livre || casa <= j);
+        if (!entre) {
+            g->suprimidas[livre] = w;
+            livre = j;
+        }
+    }
+    g->suprimidas[livre].origem = NULL;
+    g->suprimidas[livre].no = NULL;
+    g->suprimidas_usadas--;
+}
+
+/**
+ * @brief Regista a ligação implícita origem -> destino como removida.
+ * 
+ * A ligação fica na lista de suprimidas da origem, na de entradas suprimidas do
+ * destino (as duas ligadas pelo campo par, como as arestas e as entradas) e na
+ * tabela do grafo.
+ * 
+ * @param g Ponteiro para o grafo.
+ * @param origem Vértice de origem.
+ * @param destino Vértice de destino.
+ * 
+ * @return true se foi registada, false se já estava suprimida ou falhar a alocação.
+ */
+
+static bool suprimirLigacao(Grafo* g, Vertice* origem, Vertice* destino) {
+    if (ligacaoSuprimida(g, origem, destino)) return false;
+    if (!suprimidasReservar(g, g->suprimidas_usadas + 1)) return false;
+    if (!juntarALista(&origem->suprimidas, destino, &g->pool_arestas)) return false;
+    if (!juntarALista(&destino->entradas_suprimidas, origem, &g->pool_arestas)) {
+        desligarNo(&origem->suprimidas, origem->suprimidas, &g->pool_arestas);
+        return false;
+    }
+    origem->suprimidas->par = destino->entradas_suprimidas;
+    destino->entradas_suprimidas->par = origem->suprimidas;
+
+    size_t mascara = g->suprimidas_cap - 1;
+    size_t pos = dispersarChave(chaveLigacao(origem, destino), mascara);
+    while (g->suprimidas[pos].origem) pos = (pos + 1) & mascara;
+    g->suprimidas[pos].origem = origem;
+    g->suprimidas[pos].no = origem->suprimidas;
+    g->suprimidas_usadas++;
+    return true;
+}
+
+/**
+ * @brief Repõe a ligação implícita origem -> destino, se estava suprimida.
+ * 
+ * @param g Ponteiro para o grafo.
+ * @param origem Vértice de origem.
+ * @param destino Vértice de destino.
+ * 
+ * @return true se a ligação estava suprimida (e deixou de estar).
+ */
+
+static bool reporSuprimida(Grafo* g, Vertice* origem, Vertice* destino) {
+    if (!origem->suprimidas) return false;
+    LigacaoSuprimida* l = procurarSuprimida(g, origem, destino);
+    if (!l) return false;
+    Aresta* no = l->no;
+    esquecerSuprimida(g, l);
+    desligarNo(&destino->entradas_suprimidas, no->par, &g->pool_arestas);
+    desligarNo(&origem->suprimidas, no, &g->pool_arestas);
+    return true;
+}
+
+/**
+ * @brief Cria a ligação origem -> destino, explícita ou (no modo implícito) repondo uma suprimida.
+ * 
+ * É o passo comum a AdicionarAresta e inserirAresta. Entre antenas com a mesma
+ * frequência, no modo implícito, a ligação já existe, a menos que tenha sido
+ * removida antes: nesse caso basta retirá-la da lista de suprimidas.
+ * 
+ * @param g Ponteiro para o grafo.
+ * @param origem Vértice de origem.
+ * @param destino Vértice de destino.
+ * 
+ * @return true se a ligação passou a existir, false se já existia ou falhou a alocação.
+ */
+
+static bool criarLigacao(Grafo* g, Vertice* origem, Vertice* destino) {
+    if (ligacaoImplicita(g, origem, destino)) {
+        if (!reporSuprimida(g, origem, destino)) { // já existia
+            ESTAT_CONTAR(g, arestas_duplicadas);
+            return false;
+        }
+    } else {
+        if (listaContem(origem->arestas, destino)) { // evita arestas duplicadas
+            ESTAT_CONTAR(g, arestas_duplicadas);
+            return false;
+        }
+        if (!acrescentarAresta(g, origem, destino)) return false;
+    }
+    if (g->componentes_validas) ufUnir(origem, destino); // as duas antenas passam a estar na mesma componente
+    ESTAT_CONTAR(g, arestas_inseridas);
+    return true;
+}
+
+/**
+ * @brief Remove a ligação origem -> destino, explícita ou (no modo implícito) suprimindo-a.
+ * 
+ * @param g Ponteiro para o grafo.
+ * @param origem Vértice de origem.
+ * @param destino Vértice de destino.
+ * 
+ * @return true se a ligação existia e foi removida, false caso contrário.
+ */
+
+static bool cortarLigacao(Grafo* g, Vertice* origem, Vertice* destino) {
+    bool removida;
+    if (ligacaoImplicita(g, origem, destino)) {
+        removida = suprimirLigacao(g, origem, destino);
+    } else {
+        removida = retirarAresta(g, origem, destino);
+    }
+    if (removida) g->componentes_validas = false; // pode ter partido uma componente
+    return removida;
+}
+
+/**
+ * @brief Insere um lote de ligações (origem, destino), eliminando os duplicados de uma vez.
+ * 
+ * Os pares são agrupados por origem com uma ordenação por contagem, de forma
+ * estável; cada origem recebe o número do seu grupo no campo pos_lote, marcado
+ * com um carimbo novo (Vertice::carimbo), por isso o trabalho auxiliar depende
+ * do tamanho do lote e não do número de vértices do grafo. Para cada origem, os
+ * destinos que já tem são carimbados, e os novos destinos repetidos ou já
+ * existentes são descartados em O(1) cada. As arestas novas são acrescentadas
+ * ao início da lista pela ordem dos pares, e o resultado é igual ao de inserir
+ * um par de cada vez. O custo é O(P + soma dos graus das origens do lote), em
+ * vez de O(P × grau) par a par; com novos a true a lista de cada origem nem é
+ * percorrida e o custo é O(P). As ligações implícitas (modo implícito) seguem
+ * por criarLigacao.
+ * 
+ * Os nós de todas as arestas que o lote pode criar são reservados no pool antes
+ * de se mexer no grafo, por isso o lote ou é inserido por completo ou não muda
+ * nada. Se faltar memória só para os vetores auxiliares, os pares são inseridos
+ * um a um (com os nós já reservados).
+ * 
+ * @param g Ponteiro para o grafo (todos os vértices têm de pertencer a g).
+ * @param pares Vetor com 2 * numPares vértices: origem e destino de cada par (NULL é ignorado).
+ * @param numPares Número de pares.
+ * @param novos true se quem chama garante que nenhum par existe no grafo nem se
+ *        repete no lote (por exemplo, uma clique nova entre vértices sem arestas).
+ * 
+ * @return size_t Número de ligações que passaram a existir, ou LOTE_SEM_MEMORIA se
+ *         não houver memória para as arestas do lote (o grafo fica como estava).
+ */
+
+static size_t inserirLote(Grafo* g, Vertice** pares, size_t numPares, bool novos) {
+    size_t inseridas = 0;
+    if (numPares == 0) return 0;
+
+    size_t explicitas = 0; // no máximo uma aresta (e a sua entrada) nova por par explícito
+    for (size_t k = 0; k < numPares; k++) {
+        if (pares[2 * k] && pares[2 * k + 1] && !ligacaoImplicita(g, pares[2 * k], pares[2 * k + 1])) explicitas++;
+    }
+    if (!poolReservar(&g->pool_arestas, 2 * explicitas)) return LOTE_SEM_MEMORIA; // a partir daqui nada falha
+
+    if (novos) { // sem duplicados possíveis: cada par é uma aresta nova, pela ordem dada
+        for (size_t k = 0; k < numPares; k++) {
+            Vertice* origem = pares[2 * k];
+            Vertice* destino = pares[2 * k + 1];
+            if (!origem || !destino) continue;
+            if (ligacaoImplicita(g, origem, destino)) {
+                if (criarLigacao(g, origem, destino)) inseridas++;
+                continue;
+            }
+            acrescentarAresta(g, origem, destino); // os nós estão reservados
+            if (g->componentes_validas) ufUnir(origem, destino);
+            ESTAT_CONTAR(g, arestas_inseridas);
+            inseridas++;
+        }
+        return inseridas;
+    }
+
+    size_t* contagem = calloc(numPares + 1, sizeof(size_t)); // há no máximo numPares origens diferentes
+    size_t* ordem = malloc(numPares * sizeof(size_t));
+    if (!contagem || !ordem) { // sem memória para o lote: um de cada vez
+        free(contagem);
+        free(ordem);
+        for (size_t k = 0; k < numPares; k++) {
+            if (pares[2 * k] && pares[2 * k + 1] && criarLigacao(g, pares[2 * k], pares[2 * k + 1])) inseridas++;
+        }
+        return inseridas;
+    }
+
+    // numera as origens do lote e conta os pares de cada uma (as ligações implícitas não usam as listas)
+    uint64_t lote = ++g->carimbo_lote;
+    size_t numOrigens = 0;
+    for (size_t k = 0; k < numPares; k++) {
+        Vertice* origem = pares[2 * k];
+        Vertice* destino = pares[2 * k + 1];
+        if (!origem || !destino) continue;
+        if (ligacaoImplicita(g, origem, destino)) {
+            if (criarLigacao(g, origem, destino)) inseridas++;
+            continue;
+        }
+        if (origem->carimbo != lote) {
+            origem->carimbo = lote;
+            origem->pos_lote = (int)numOrigens++;
+        }
+        contagem[origem->pos_lote + 1]++;
+    }
+    for (size_t b = 0; b < numOrigens; b++) contagem[b + 1] += contagem[b];
+    for (size_t k = 0; k < numPares; k++) { // distribui de forma estável pelos grupos de cada origem
+        Vertice* origem = pares[2 * k];
+        Vertice* destino = pares[2 * k + 1];
+        if (!origem || !destino || ligacaoImplicita(g, origem, destino)) continue;
+        ordem[contagem[origem->pos_lote]++] = k;
+    }
+
+    // agora o grupo b ocupa ordem[contagem[b - 1] .. contagem[b] - 1]
+    for (size_t b = 0; b < numOrigens; b++) {
+        size_t primeiro = b ? contagem[b - 1] : 0;
+        Vertice* origem = pares[2 * ordem[primeiro]];
+        uint64_t carimbo = ++g->carimbo_lote;
+        for (Aresta* a = origem->arestas; a != NULL; a = a->prox) a->destino->carimbo = carimbo; // destinos que já tem
+        for (size_t k = primeiro; k < contagem[b]; k++) {
+            Vertice* destino = pares[2 * ordem[k] + 1];
+            if (destino->carimbo == carimbo) { // duplicado
+                ESTAT_CONTAR(g, arestas_duplicadas);
+                continue;
+            }
+            destino->carimbo = carimbo;
+            acrescentarAresta(g, origem, destino); // os nós estão reservados
+            if (g->componentes_validas) ufUnir(origem, destino);
+            ESTAT_CONTAR(g, arestas_inseridas);
+            inseridas++;
+        }
+    }
+
+    free(contagem);
+    free(ordem);
+    return inseridas;
+}
+
+/**
+ * @brief Prepara um iterador sobre os vizinhos de um vértice.
+ * 
+ * Os vizinhos são primeiro os destinos das arestas guardadas e depois, no modo
+ * implícito, os outros membros do grupo de frequência do vértice (exceto os
+ * que estão na lista de suprimidas). O grafo não deve ser alterado enquanto
+ * o iterador estiver a ser usado.
+ * 
+ * @param it Iterador a preparar.
+ * @param v Vértice cujos vizinhos se vão percorrer.
+ * 
+ * @return true se o iterador ficou pronto, false se algum ponteiro for NULL
+ *         (com v NULL o iterador fica vazio).
+ */
+
+bool iniciarVizinhos(IteradorVizinhos* it, Vertice* v) {
+    if (!it) return false;
+    it->v = v;
+    it->a = v ? v->arestas : NULL;
+    it->i = 0;
+    return v != NULL;
+}
+
+/**
+ * @brief Devolve o próximo vizinho de um iterador.
+ * 
+ * @param it Iterador preparado com iniciarVizinhos.
+ * 
+ * @return Vertice* O próximo vizinho, ou NULL quando não houver mais.
+ */
+
+Vertice* proximoVizinho(IteradorVizinhos* it) {
+    if (it->a) { // primeiro as arestas guardadas
+        Vertice* d = it->a->destino;
+        it->a = it->a->prox;
+        ESTAT_CONTAR(it->v->dono, vizinhos_percorridos);
+        return d;
+    }
+    if (!it->v) return NULL; // iterador vazio
+    Grafo* g = it->v->dono;
+    if (!g->arestas_implicitas || !frequenciaLigavel(it->v->freq)) return NULL;
+
+    GrupoFrequencia* grupo = &g->grupos[(unsigned char)it->v->freq];
+    while (it->i < grupo->tamanho) {
+        Vertice* w = grupo->membros[it->i++];
+        if (w == it->v) continue;
+        if (ligacaoSuprimida(g, it->v, w)) continue; // ligação removida, consultada em O(1)
+        ESTAT_CONTAR(g, vizinhos_percorridos);
+        return w;
+    }
+    return NULL;
+}
+
+/**
+ * @brief Acrescenta um vértice ao grupo da sua frequência.
+ * 
+ * @param g Ponteiro para o grafo.
+ * @param v Vértice a acrescentar.
+ * 
+ * @return true se foi acrescentado, false se falhar a alocação.
+ */
+
+static bool grupoInserir(Grafo* g, Vertice* v) {
+    GrupoFrequencia* grupo = &g->grupos[(unsigned char)v->freq];
+    if (grupo->tamanho == grupo->cap) {
+        int cap = grupo->cap ? grupo->cap * 2 : 16;
+        Vertice** maior = realloc(grupo->membros, (size_t)cap * sizeof(Vertice*));
+        if (!maior) return false;
+        grupo->membros = maior;
+        grupo->cap = cap;
+    }
+    v->pos_grupo = grupo->tamanho;
+    grupo->membros[grupo->tamanho++] = v;
+    return true;
+}
+
+/**
+ * @brief Retira um vértice do grupo da sua frequência em O(1) (troca com o último).
+ * 
+ * @param g Ponteiro para o grafo.
+ * @param v Vértice a retirar.
+ */
+
+static void grupoRemover(Grafo* g, Vertice* v) {
+    GrupoFrequencia* grupo = &g->grupos[(unsigned char)v->freq];
+    Vertice* ultimo = grupo->membros[--grupo->tamanho];
+    grupo->membros[v->pos_grupo] = ultimo;
+    ultimo->pos_grupo = v->pos_grupo;
+}
+
+/**
+ * @brief Procura a posição de uma célula na tabela da grelha espacial.
+ * 
+ * @param g Ponteiro para o grafo.
+ * @param cx Coordenada X da célula.
+ * @param cy Coordenada Y da célula.
+ * 
+ * @return CelulaEspacial* A célula, ou NULL se nunca foi criada.
+ */
+
+static CelulaEspacial* grelhaCelula(Grafo* g, int cx, int cy) {
+    if (g->celulas_cap == 0) return NULL;
+    size_t mascara = g->celulas_cap - 1;
+    size_t pos = dispersarChave(chaveCoordenadas(cx, cy), mascara);
+    while (g->celulas[pos].usada) {
+        if (g->celulas[pos].cx == cx && g->celulas[pos].cy == cy) return &g->celulas[pos];
+        pos = (pos + 1) & mascara;
+    }
+    return NULL;
+}
+
+/**
+ * @brief Devolve a célula (cx, cy) da grelha, criando-a se for preciso.
+ * 
+ * A tabela é mantida com fator de carga máximo de 1/2, como o índice de coordenadas.
+ * 
+ * @param g Ponteiro para o grafo.
+ * @param cx Coordenada X da célula.
+ * @param cy Coordenada Y da célula.
+ * 
+ * @return CelulaEspacial* A célula, ou NULL se falhar a alocação.
+ */
+
+static CelulaEspacial* grelhaObterCelula(Grafo* g, int cx, int cy) {
+    CelulaEspacial* existente = grelhaCelula(g, cx, cy);
+    if (existente) return existente;
+
+    if ((g->celulas_usadas + 1) * 2 > g->celulas_cap) { // cresce e reinsere as células
+        size_t cap = g->celulas_cap ? g->celulas_cap * 2 : 64;
+        CelulaEspacial* nova = calloc(cap, sizeof(CelulaEspacial));
+        if (!nova) return NULL;
+        for (size_t i = 0; i < g->celulas_cap; i++) {
+            if (!g->celulas[i].usada) continue;
+            size_t pos = dispersarChave(chaveCoordenadas(g->celulas[i].cx, g->celulas[i].cy), cap - 1);
+            while (nova[pos].usada) pos = (pos + 1) & (cap - 1);
+            nova[pos] = g->celulas[i];
+        }
+        free(g->celulas);
+        g->celulas = nova;
+        g->celulas_cap = cap;
+    }
+
+    size_t mascara = g->celulas_cap - 1;
+    size_t pos = dispersarChave(chaveCoordenadas(cx, cy), mascara);
+    while (g->celulas[pos].usada) pos = (pos + 1) & mascara;
+    CelulaEspacial* c = &g->celulas[pos];
+    c->cx = cx;
+    c->cy = cy;
+    c->usada = true;
+    c->membros = NULL;
+    c->tamanho = 0;
+    c->cap = 0;
+    g->celulas_usadas++;
+    return c;
+}
+
+/**
+ * @brief Acrescenta um vértice à sua célula da grelha espacial.
+ * 
+ * @param g Ponteiro para o grafo.
+ * @param v Vértice a acrescentar.
+ * 
+ * @return true se foi acrescentado, false se falhar a alocação.
+ */
+
+static bool grelhaInserir(Grafo* g, Vertice* v) {
+    CelulaEspacial* c = grelhaObterCelula(g, v->x >> GRELHA_BITS, v->y >> GRELHA_BITS);
+    if (!c) return false;
+    if (c->tamanho == c->cap) {
+        int cap = c->cap ? c->cap * 2 : 4;
+        Vertice** maior = realloc(c->membros, (size_t)cap * sizeof(Vertice*));
+        if (!maior) return false;
+        c->membros = maior;
+        c->cap = cap;
+    }
+    v->pos_celula = c->tamanho;
+    c->membros[c->tamanho++] = v;
+    return true;
+}
+
+/**
+ * @brief Retira um vértice da sua célula da grelha espacial em O(1) (troca com o último).
+ * 
+ * @param g Ponteiro para o grafo.
+ * @param v Vértice a retirar.
+ */
+
+static void grelhaRemover(Grafo* g, Vertice* v) {
+    CelulaEspacial* c = grelhaCelula(g, v->x >> GRELHA_BITS, v->y >> GRELHA_BITS);
+    if (!c) return;
+    Vertice* ultimo = c->membros[--c->tamanho];
+    c->membros[v->pos_celula] = ultimo;
+    ultimo->pos_celula = v->pos_celula;
+}
+
+/**
+ * @brief Chama uma função para cada antena dentro de um retângulo (limites incluídos).
+ * 
+ * Só são visitadas as células que intersetam o retângulo ou, se o retângulo
+ * abranger mais células do que as posições da tabela, as células que existem.
+ * A ordem das antenas não é garantida.
+ * 
+ * @param g Ponteiro para o grafo.
+ * @param x0 Coordenada X mínima.
+ * @param y0 Coordenada Y mínima.
+ * @param x1 Coordenada X máxima.
+ * @param y1 Coordenada Y máxima.
+ * @param visitar Função chamada com cada antena e com contexto.
+ * @param contexto Dados passados a visitar.
+ */
+
+static void percorrerGrelha(Grafo* g, int x0, int y0, int x1, int y1,
+                            void (*visitar)(Vertice* v, void* contexto), void* contexto) {
+    int cx0 = x0 >> GRELHA_BITS, cx1 = x1 >> GRELHA_BITS;
+    int cy0 = y0 >> GRELHA_BITS, cy1 = y1 >> GRELHA_BITS;
+    uint64_t numCelulas = ((uint64_t)((int64_t)cx1 - cx0) + 1) * ((uint64_t)((int64_t)cy1 - cy0) + 1);
+    bool porTabela = numCelulas > g->celulas_cap; // retângulo enorme: percorre só as células que existem
+    size_t total = porTabela ? g->celulas_cap : (size_t)numCelulas;
+
+    for (size_t i = 0; i < total; i++) {
+        CelulaEspacial* c;
+        if (porTabela) {
+            c = &g->celulas[i];
+            if (!c->usada || c->cx < cx0 || c->cx > cx1 || c->cy < cy0 || c->cy > cy1) continue;
+        } else {
+            size_t largura = (size_t)((int64_t)cx1 - cx0) + 1;
+            c = grelhaCelula(g, cx0 + (int)(i % largura), cy0 + (int)(i / largura));
+            if (!c) continue;
+        }
+        for (int k = 0; k < c->tamanho; k++) {
+            Vertice* v = c->membros[k];
+            if (v->x < x0 || v->x > x1 || v->y < y0 || v->y > y1) continue;
+            visitar(v, contexto);
+        }
+    }
+}
+
+/// @brief Estado de recolherNaGrelha: círculo opcional e vetor de resultados
+typedef struct Recolha {
+    int x, y;                  ///< Centro do círculo
+    int64_t r2;                ///< Quadrado do raio, ou -1 para aceitar todo o retângulo
+    Vertice** resultado;       ///< Vetor de resultados (pode ser NULL)
+    int cap;                   ///< Capacidade do vetor
+    int encontrados;           ///< Antenas aceites até agora
+} Recolha;
+
+/**
+ * @brief Guarda uma antena na recolha, se estiver dentro do círculo.
+ * 
+ * @param v Antena do retângulo.
+ * @param contexto A Recolha.
+ */
+
+static void recolherAntena(Vertice* v, void* contexto) {
+    Recolha* r = contexto;
+    if (r->r2 >= 0) {
+        int64_t dx = (int64_t)v->x - r->x, dy = (int64_t)v->y - r->y;
+        if (dx * dx + dy * dy > r->r2) return;
+    }
+    if (r->resultado && r->encontrados < r->cap) r->resultado[r->encontrados] = v;
+    r->encontrados++;
+}
+
+/**
+ * @brief Recolhe as antenas de um retângulo, opcionalmente só as de dentro de um círculo.
+ * 
+ * @param g Ponteiro para o grafo.
+ * @param x0 Coordenada X mínima.
+ * @param y0 Coordenada Y mínima.
+ * @param x1 Coordenada X máxima.
+ * @param y1 Coordenada Y máxima.
+ * @param x Coordenada X do centro do círculo.
+ * @param y Coordenada Y do centro do círculo.
+ * @param r2 Quadrado do raio do círculo, ou -1 para aceitar todo o retângulo.
+ * @param resultado Vetor de resultados (pode ser NULL).
+ * @param cap Capacidade do vetor.
+ * 
+ * @return int Número total de antenas encontradas.
+ */
+
+static int recolherNaGrelha(Grafo* g, int x0, int y0, int x1, int y1, int x, int y, int64_t r2,
+                            Vertice** resultado, int cap) {
+    Recolha r = { x, y, r2, resultado, cap, 0 };
+    percorrerGrelha(g, x0, y0, x1, y1, recolherAntena, &r);
+    return r.encontrados;
+}
+
+/**
+ * @brief Encontra todas as antenas dentro de um retângulo (limites incluídos).
+ * 
+ * Usa a grelha espacial, por isso o custo depende da área pedida e das antenas
+ * que lá estão, e não do tamanho do grafo.
+ * 
+ * @param g Ponteiro para o grafo.
+ * @param x0 Coordenada X mínima.
+ * @param y0 Coordenada Y mínima.
+ * @param x1 Coordenada X máxima.
+ * @param y1 Coordenada Y máxima.
+ * @param resultado Vetor onde são escritas as antenas encontradas (pode ser NULL para só contar).
+ * @param capResultado Capacidade do vetor; as antenas a mais são contadas mas não escritas.
+ * 
+ * @return int Número total de antenas no retângulo.
+ */
+
+int procurarNoRetangulo(Grafo* g, int x0, int y0, int x1, int y1, Vertice** resultado, int capResultado) {
+    if (!g || x0 > x1 || y0 > y1) return 0;
+    return recolherNaGrelha(g, x0, y0, x1, y1, 0, 0, -1, resultado, capResultado);
+}
+
+/**
+ * @brief Limita um valor de 64 bits ao intervalo de int.
+ * 
+ * @param valor Valor a limitar.
+ * 
+ * @return int INT_MIN, INT_MAX ou o próprio valor.
+ */
+
+static int limitarInt(int64_t valor) {
+    if (valor < INT_MIN) return INT_MIN;
+    if (valor > INT_MAX) return INT_MAX;
+    return (int)valor;
+}
+
+/**
+ * @brief Encontra todas as antenas a uma distância (euclidiana) de (x, y) menor ou igual a raio.
+ * 
+ * @param g Ponteiro para o grafo.
+ * @param x Coordenada X do centro.
+ * @param y Coordenada Y do centro.
+ * @param raio Raio da procura.
+ * @param resultado Vetor onde são escritas as antenas encontradas (pode ser NULL para só contar).
+ * @param capResultado Capacidade do vetor; as antenas a mais são contadas mas não escritas.
+ * 
+ * @return int Número total de antenas dentro do círculo.
+ */
+
+int procurarNoRaio(Grafo* g, int x, int y, int raio, Vertice** resultado, int capResultado) {
+    if (!g || raio < 0) return 0;
+    // o quadrado que contém o círculo pode sair do intervalo de int: as antenas não
+    int x0 = limitarInt((int64_t)x - raio), x1 = limitarInt((int64_t)x + raio);
+    int y0 = limitarInt((int64_t)y - raio), y1 = limitarInt((int64_t)y + raio);
+    return recolherNaGrelha(g, x0, y0, x1, y1, x, y, (int64_t)raio * raio, resultado, capResultado);
+}
+
+/**
+ * @brief Encontra a antena com uma dada frequência mais próxima (distância euclidiana) de (x, y).
+ * 
+ * Percorre a grelha espacial em anéis de células à volta do ponto, e para assim
+ * que nenhuma célula do anel seguinte pode ter uma antena mais próxima do que a
+ * melhor encontrada. Se os anéis custarem mais do que percorrer as antenas da
+ * frequência (por exemplo, frequências raras longe do ponto), passa a percorrer
+ * o grupo dessa frequência diretamente.
+ * 
+ * @param g Ponteiro para o grafo.
+ * @param x Coordenada X do ponto.
+ * @param y Coordenada Y do ponto.
+ * @param freq Frequência procurada.
+ * 
+ * @return Vertice* A antena mais próxima, ou NULL se não houver nenhuma com essa frequência.
+ */
+
+Vertice* antenaMaisProxima(Grafo* g, int x, int y, char freq) {
+    if (!g) return NULL;
+    GrupoFrequencia* grupo = &g->grupos[(unsigned char)freq];
+    if (grupo->tamanho == 0) return NULL;
+
+    Vertice* melhor = NULL;
+    int64_t melhorD2 = INT64_MAX;
+    int cx = x >> GRELHA_BITS, cy = y >> GRELHA_BITS;
+    size_t trabalho = 0;
+    for (int k = 0; ; k++) {
+        if (k > 0 && melhor) {
+            int64_t limite = (int64_t)(k - 1) * GRELHA_LADO; // distância mínima a qualquer célula do anel k
+            if (limite * limite > melhorD2) break;
+        }
+        if (trabalho > (size_t)grupo->tamanho) { // os anéis já custaram mais do que o grupo inteiro
+            for (int i = 0; i < grupo->tamanho; i++) {
+                Vertice* v = grupo->membros[i];
+                int64_t dx = (int64_t)v->x - x, dy = (int64_t)v->y - y;
+                if (dx * dx + dy * dy < melhorD2) {
+                    melhorD2 = dx * dx + dy * dy;
+                    melhor = v;
+                }
+            }
+            break;
+        }
+
+        // células à distância (em células) exatamente k: nas linhas do meio só as duas pontas
+        for (int ccy = cy - k; ccy <= cy + k; ccy++) {
+            int passo = (ccy == cy - k || ccy == cy + k) ? 1 : 2 * k;
+            for (int ccx = cx - k; ccx <= cx + k; ccx += passo) {
+                trabalho++;
+                CelulaEspacial* c = grelhaCelula(g, ccx, ccy);
+                if (!c) continue;
+                for (int m = 0; m < c->tamanho; m++) {
+                    Vertice* v = c->membros[m];
+                    trabalho++;
+                    if (v->freq != freq) continue;
+                    int64_t dx = (int64_t)v->x - x, dy = (int64_t)v->y - y;
+                    if (dx * dx + dy * dy < melhorD2) {
+                        melhorD2 = dx * dx + dy * dy;
+                        melhor = v;
+                    }
+                }
+            }
+        }
+    }
+    return melhor;
+}
+
+/**
+ * @brief Junta as componentes dos membros de um grupo de frequência (modo implícito).
+ * 
+ * Dois membros u e w estão ligados, nos dois sentidos, a menos que u -> w e
+ * w -> u estejam ambas suprimidas. A procura é feita no grafo complementar: a
+ * partir de cada membro tentam-se só os membros que ainda não foram alcançados,
+ * e cada tentativa ou alcança um membro novo ou corresponde a um par suprimido,
+ * por isso o custo é O(k + S) para um grupo de k membros com S ligações
+ * suprimidas, em vez de O(k²). Se faltar memória para os vetores auxiliares,
+ * os membros são ligados um a um pelo iterador de vizinhos.
+ * 
+ * @param g Ponteiro para o grafo.
+ * @param grupo Grupo de frequência (ligável e com pelo menos dois membros).
+ */
+
+static void unirGrupo(Grafo* g, GrupoFrequencia* grupo) {
+    Vertice** restantes = malloc(2 * (size_t)grupo->tamanho * sizeof(Vertice*));
+    if (!restantes) {
+        for (int i = 0; i < grupo->tamanho; i++) {
+            IteradorVizinhos it = { grupo->membros[i], NULL, 0 }; // as arestas explícitas já foram tratadas
+            for (Vertice* w = proximoVizinho(&it); w != NULL; w = proximoVizinho(&it)) ufUnir(grupo->membros[i], w);
+        }
+        return;
+    }
+    Vertice** fila = restantes + grupo->tamanho;
+    memcpy(restantes, grupo->membros, (size_t)grupo->tamanho * sizeof(Vertice*));
+
+    int numRestantes = grupo->tamanho;
+    while (numRestantes > 0) {
+        int tamFila = 0;
+        fila[tamFila++] = restantes[--numRestantes];
+        for (int q = 0; q < tamFila && numRestantes > 0; q++) {
+            Vertice* u = fila[q];
+            int ficam = 0;
+            for (int i = 0; i < numRestantes; i++) {
+                Vertice* w = restantes[i];
+                if (ligacaoSuprimida(g, u, w) && ligacaoSuprimida(g, w, u)) {
+                    restantes[ficam++] = w; // sem ligação com u: fica para os próximos
+                } else {
+                    ufUnir(u, w);
+                    fila[tamFila++] = w;
+                }
+            }
+            numRestantes = ficam;
+        }
+    }
+    free(restantes);
+}
+
+/**
+ * @brief Volta a calcular as componentes a partir das listas de arestas.
+ * 
+ * A estrutura union-find não suporta remoções; depois de uma remoção o grafo
+ * fica marcado e esta função refaz tudo em O((V + E) α(V)) na consulta seguinte
+ * (mais O(V + S) para os grupos de frequência no modo implícito, ver unirGrupo).
+ * 
+ * @param g Ponteiro para o grafo.
+ */
+
+static void reconstruirComponentes(Grafo* g) {
+    for (Vertice* v = g->vertices; v != NULL; v = v->prox) {
+        v->uf_pai = v;
+        v->uf_rank = 0;
+        v->uf_tamanho = 1;
+    }
+    for (Vertice* v = g->vertices; v != NULL; v = v->prox) {
+        for (Aresta* a = v->arestas; a != NULL; a = a->prox) ufUnir(v, a->destino);
+    }
+
+    if (g->arestas_implicitas) {
+        for (int f = 0; f < 256; f++) {
+            GrupoFrequencia* grupo = &g->grupos[f];
+            if (!frequenciaLigavel((char)f) || grupo->tamanho < 2) continue;
+            if (g->suprimidas_usadas == 0) { // nada suprimido: o grupo é uma só componente
+                for (int i = 1; i < grupo->tamanho; i++) ufUnir(grupo->membros[0], grupo->membros[i]);
+            } else {
+                unirGrupo(g, grupo);
+            }
+        }
+    }
+    g->componentes_validas = true;
+}
+
+/**
+ * @brief Cria um vértice e liga-o ao grafo, sem verificar se as coordenadas já estão ocupadas.
+ * 
+ * Faz o trabalho comum a AdicionarVertice e às leituras em massa (que já sabem
+ * que as coordenadas são únicas): obtém o nó do pool, regista-o no índice de
+ * coordenadas e insere-o no início da lista de vértices.
+ * 
+ * @param g Ponteiro para o grafo.
+ * @param x Coordenada X do novo vértice.
+ * @param y Coordenada Y do novo vértice.
+ * @param freq Frequência associada ao vértice.
+ * 
+ * @return Vertice* O vértice criado, ou NULL se falhar a alocação.
+ */
+
+static Vertice* criarVertice(Grafo* g, int x, int y, char freq) {
+    if (g->ids_livres_tam == 0 && (g->proximo_id == INT32_MAX || !idsReservar(g, g->proximo_id + 1))) return NULL; // sem id para o vértice
+    Vertice* novo = poolAlocar(&g->pool_vertices);// obtém um vértice do pool do grafo
+    if (!novo) return NULL; // Se falhar a alocação, o grafo fica sem alterações
+
+    novo->x = x; // atualiza a cordenada x nova para o x do vertice criado
+    novo->y = y; // atualiza y
+    novo->freq = freq; 
+    novo->arestas = NULL;//o vertice criado (nasce) sem ligacao nenhumaou seja sem aresta
+    novo->entradas = NULL;
+    novo->suprimidas = NULL;
+    novo->entradas_suprimidas = NULL;
+    if (!indiceInserir(g, novo)) { // coordenadas ocupadas ou sem espaço no índice
+        poolLibertar(&g->pool_vertices, novo);
+        return NULL;
+    }
+    if (!grupoInserir(g, novo)) { // sem espaço no grupo da frequência
+        indiceRemover(g, novo);
+        poolLibertar(&g->pool_vertices, novo);
+        return NULL;
+    }
+    if (!grelhaInserir(g, novo)) { // sem espaço na grelha espacial
+        grupoRemover(g, novo);
+        indiceRemover(g, novo);
+        poolLibertar(&g->pool_vertices, novo);
+        return NULL;
+    }
+    idAtribuir(g, novo);  // Atribui ID único (reutiliza os dos vértices removidos)
+    novo->marca = 0; // a época 0 nunca é usada por uma travessia
+    novo->pos = -1; // ainda não pertence a nenhum instantâneo CSR
+    novo->carimbo = 0;
+    novo->dono = g;
+    novo->uf_pai = novo; // cada vértice novo é uma componente sozinho
+    novo->uf_rank = 0;
+    novo->uf_tamanho = 1;
+    GrupoFrequencia* grupo = &g->grupos[(unsigned char)freq];
+    if (g->componentes_validas && g->arestas_implicitas && frequenciaLigavel(freq) && grupo->tamanho > 1) {
+        ufUnir(novo, grupo->membros[0]); // no modo implícito já fica ligado ao resto do grupo
+    }
+    novo->prox = g->vertices; 
+    novo->ant = NULL;
+    if (g->vertices) g->vertices->ant = novo;
+    g->vertices = novo;   // Liga o novo vértice à lista de vértices do grafo (inserção no início da lista)
+    g->num_vertices++; // mais um vertice para o grafo
+    return novo;
+}
+
+/**
+ * @brief Adiciona um novo vértice ao grafo com coordenadas e frequência especificadas.
+ * 
+ * Esta função cria um novo vértice, inicializa os seus campos com as coordenadas (x, y),
+ * frequência e um ID único. O vértice é inserido no início da lista de vértices do grafo.
+ * 
+ * Antes de adicionar, verifica se já existe um vértice com as mesmas coordenadas.
+ * Se existir, não adiciona e retorna o grafo original. O novo vértice é também
+ * registado no índice de coordenadas usado por ProcurarVertice.
+ * 
+ * @param g Ponteiro para o grafo onde o vértice será adicionado.
+ * @param x Coordenada X do novo vértice.
+ * @param y Coordenada Y do novo vértice.
+ * @param freq Frequência associada ao vértice.
+ * @param sucesso Ponteiro para booleano que indica se a adição foi bem-sucedida.
+ * 
+ * @return Grafo* Ponteiro para o grafo atualizado.
+ */
+
+Grafo* AdicionarVertice(Grafo* g, int x, int y, char freq, bool* sucesso) {
+    *sucesso = false; // o ponteiro sucesso é definio como false
+    if (ProcurarVertice(g, x, y)) return g; // Verifica se já existe um vértice com as mesmas coordenadas
+
+    if (criarVertice(g, x, y, freq)) *sucesso = true; // vertice adicionado com sucesso
+    return g; // retorna o grafo com um vertice a mais
+}
+
+/**
+ * @brief Liberta a memória ocupada por uma lista ligada de arestas.
+ * 
+ * Esta função percorre a lista ligada de arestas, devolvendo cada nó ao pool
+ * de arestas do grafo a que pertence, para poder ser reutilizado.
+ * 
+ * @param a Ponteiro para o início da lista ligada de arestas.
+ * 
+ * @return bool Retorna true após libertar toda a lista.
+ */
+
+bool LibertarListaArestas(Aresta* a) {
+    while (a) { // Enquanto existir uma aresta na lista
+        Aresta* temp = a; // Guarda o ponteiro atual numa variável temporária
+        a = a->prox; // Avança para a próxima aresta da lista
+        poolLibertar(&temp->destino->dono->pool_arestas, temp);  // Devolve a aresta ao pool do grafo
+    }
+    return true; // retorna bool se for uma funcao bem sucedida por ser booleana
+}
+
+/**
+ * @brief Remove a aresta entre dois vértices no grafo.
+ * 
+ * Esta função procura os vértices de origem e destino no grafo e remove
+ * as arestas que ligam esses dois vértices em ambas as direções (origem->destino e destino->origem).
+ * No modo implícito, uma ligação entre antenas da mesma frequência é removida
+ * registando-a na lista de suprimidas de cada um. Se os vértices não existirem,
+ * não faz alterações.
+ * 
+ * @param g Ponteiro para o grafo onde a remoção será feita.
+ * @param xOrig Coordenada X do vértice de origem.
+ * @param yOrig Coordenada Y do vértice de origem.
+ * @param xDest Coordenada X do vértice de destino.
+ * @param yDest Coordenada Y do vértice de destino.
+ * @param sucesso Ponteiro para variável booleana que indica se a remoção foi bem sucedida.
+ * 
+ * @return Grafo* Ponteiro para o grafo atualizado.
+ */
+
+Grafo* RemoverAresta(Grafo* g, int xOrig, int yOrig, int xDest, int yDest, bool* sucesso) {
+    *sucesso = false;
+    Vertice* origem = ProcurarVertice(g, xOrig, yOrig); // procura o vertice inicial o primeiro
+    Vertice* destino = ProcurarVertice(g, xDest, yDest); // procura o vertice final ou a seguir ou seja os dois ligados
+    if (!origem || !destino) return g; // se nao encontrar nenhum vertice com as coordenadas pedidas devolve o grafo sem alteracoes
+
+    if (cortarLigacao(g, origem, destino)) *sucesso = true; // origem -> destino
+    if (cortarLigacao(g, destino, origem)) *sucesso = true; // o mesmo processo so q ao contrario
+    return g;
+}
+
+/**
+ * @brief Devolve ao pool todos os nós das listas de um vértice.
+ * 
+ * Os nós são devolvidos ao pool do grafo do destino, por isso os destinos
+ * ainda não podem ter sido devolvidos ao pool de vértices.
+ * 
+ * @param v Vértice cujas listas são libertadas.
+ */
+
+static void libertarListasVertice(Vertice* v) {
+    LibertarListaArestas(v->arestas);
+    LibertarListaArestas(v->entradas);
+    LibertarListaArestas(v->suprimidas);
+    LibertarListaArestas(v->entradas_suprimidas);
+}
+
+/**
+ * @brief Retira um vértice (já sem ligações nem listas) das estruturas do grafo.
+ * 
+ * Tira-o do índice de coordenadas, do grupo da frequência, da grelha espacial,
+ * da tabela de ids e da lista de vértices, e devolve-o ao pool.
+ * 
+ * @param g Ponteiro para o grafo.
+ * @param v Vértice a retirar.
+ */
+
+static void retirarVertice(Grafo* g, Vertice* v) {
+    indiceRemover(g, v); // deixa de estar no índice de coordenadas
+    grupoRemover(g, v); // e no grupo da sua frequência
+    grelhaRemover(g, v); // e na grelha espacial
+    idLibertar(g, v); // o seu id pode ser dado ao próximo vértice criado
+
+    if (v->ant) v->ant->prox = v->prox; // a lista é duplamente ligada: sai em O(1)
+    else g->vertices = v->prox;
+    if (v->prox) v->prox->ant = v->ant;
+    poolLibertar(&g->pool_vertices, v); // devolve o vertice removido ao pool
+    g->num_vertices--;
+}
+
+/**
+ * @brief Desliga as ligações de um vértice a marcar para remoção dos vértices que ficam.
+ * 
+ * Cada aresta, entrada e ligação suprimida (nos dois sentidos) tem um par na
+ * lista do outro extremo, retirado em O(1) pelo campo par, e as suprimidas
+ * saem da tabela do grafo também em O(1). As ligações com vértices que também
+ * vão ser removidos (Vertice::carimbo igual a lote) ficam, porque saem com as
+ * listas desses vértices. As listas do próprio vértice não são libertadas.
+ * 
+ * @param g Ponteiro para o grafo.
+ * @param v Vértice a remover.
+ * @param lote Carimbo dos vértices a remover (o de v incluído).
+ */
+
+static void desligarDosVizinhos(Grafo* g, Vertice* v, uint64_t lote) {
+    for (Aresta* a = v->arestas; a != NULL; a = a->prox) {
+        if (a->destino->carimbo != lote) desligarNo(&a->destino->entradas, a->par, &g->pool_arestas);
+    }
+    for (Aresta* e = v->entradas; e != NULL; e = e->prox) {
+        if (e->destino->carimbo != lote) desligarNo(&e->destino->arestas, e->par, &g->pool_arestas);
+    }
+    for (Aresta* a = v->suprimidas; a != NULL; a = a->prox) { // v -> destino: v trata da tabela
+        esquecerSuprimida(g, procurarSuprimida(g, v, a->destino));
+        if (a->destino->carimbo != lote) desligarNo(&a->destino->entradas_suprimidas, a->par, &g->pool_arestas);
+    }
+    for (Aresta* e = v->entradas_suprimidas; e != NULL; e = e->prox) { // origem -> v: se a origem também sai, trata ela
+        Vertice* origem = e->destino;
+        if (origem->carimbo == lote) continue;
+        esquecerSuprimida(g, procurarSuprimida(g, origem, v));
+        desligarNo(&origem->suprimidas, e->par, &g->pool_arestas);
+    }
+}
+
+/**
+ * @brief Retira um vértice do grafo, com as suas ligações, e devolve-o ao pool.
+ * 
+ * Só toca nos vizinhos reais do vértice (ver desligarDosVizinhos), por isso o
+ * custo é O(grau do vértice + ligações suprimidas que o envolvem), também no
+ * modo implícito. Não invalida as componentes; quem chama trata disso.
+ * 
+ * @param g Ponteiro para o grafo.
+ * @param v Vértice a retirar.
+ */
+
+static void desligarVertice(Grafo* g, Vertice* v) {
+    uint64_t lote = ++g->carimbo_lote;
+    v->carimbo = lote;
+    desligarDosVizinhos(g, v, lote);
+    libertarListasVertice(v);
+    retirarVertice(g, v);
+}
+
+/**
+ * @brief Remove um vértice do grafo com todas as suas ligações.
+ * 
+ * Esta função procura o vértice no grafo com as coordenadas fornecidas (x, y)
+ * e remove-o da lista de vértices. Antes de remover, elimina todas as arestas 
+ * que apontam para esse vértice, garantindo que não fiquem ligações pendentes.
+ * As arestas que chegam ao vértice são encontradas pela sua lista de entradas
+ * e cada uma sai da lista da origem em O(1), por isso o custo é proporcional
+ * ao número de ligações do vértice e não ao tamanho do grafo. Se o vértice não existir, o grafo permanece inalterado.
+ * 
+ * @param g Ponteiro para o grafo onde será feita a remoção.
+ * @param x Coordenada X do vértice a remover.
+ * @param y Coordenada Y do vértice a remover.
+ * @param sucesso Ponteiro para variável booleana que indica se a remoção foi bem sucedida.
+ * 
+ * @return Grafo* Ponteiro para o grafo atualizado.
+ */
+
+Grafo* RemoverVertice(Grafo* g, int x, int y, bool* sucesso) {
+    *sucesso = false;
+    Vertice* atual = ProcurarVertice(g, x, y); // O(1) pelo índice de coordenadas
+    if (!atual) return g; // retorna o grafo se nao encontrar o vertice pretendido
+
+    desligarVertice(g, atual);
+    g->componentes_validas = false; // as componentes têm de ser recalculadas
+    *sucesso = true;
+    return g;
+}
+
+/**
+ * @brief Remove vários vértices, dados por coordenadas, numa só passagem.
+ * 
+ * Cada vértice ocupa dois inteiros seguidos (x, y). As coordenadas que não
+ * correspondem a nenhum vértice (ou que se repetem) são ignoradas. Os vértices
+ * a remover são primeiro marcados (Vertice::carimbo); depois só as ligações com
+ * vértices que ficam são desligadas, em O(1) cada, e as ligações entre vértices
+ * removidos vão com as listas destes. Todas as listas são libertadas antes de
+ * o primeiro vértice voltar ao pool. O custo é O(soma dos graus e das ligações
+ * suprimidas dos vértices removidos), e as componentes só são invalidadas uma
+ * vez no fim.
+ * 
+ * @param g Ponteiro para o grafo.
+ * @param coordenadas Vetor com 2 * numVertices inteiros.
+ * @param numVertices Número de vértices a remover.
+ * 
+ * @return size_t Número de vértices removidos.
+ */
+
+size_t RemoverVerticesEmLote(Grafo* g, const int* coordenadas, size_t numVertices) {
+    if (!g || !coordenadas || numVertices == 0) return 0;
+    Vertice** vitimas = malloc(numVertices * sizeof(Vertice*));
+    size_t removidos = 0;
+    if (!vitimas) { // sem memória para o lote: um de cada vez
+        for (size_t k = 0; k < numVertices; k++) {
+            Vertice* v = ProcurarVertice(g, coordenadas[2 * k], coordenadas[2 * k + 1]);
+            if (!v) continue;
+            desligarVertice(g, v);
+            removidos++;
+        }
+        if (removidos) g->componentes_validas = false;
+        return removidos;
+    }
+
+    uint64_t lote = ++g->carimbo_lote;
+    for (size_t k = 0; k < numVertices; k++) {
+        Vertice* v = ProcurarVertice(g, coordenadas[2 * k], coordenadas[2 * k + 1]);
+        if (!v || v->carimbo == lote) continue;
+        v->carimbo = lote;
+        vitimas[removidos++] = v;
+    }
+
+    for (size_t k = 0; k < removidos; k++) desligarDosVizinhos(g, vitimas[k], lote); // só dos vizinhos que ficam
+    for (size_t k = 0; k < removidos; k++) libertarListasVertice(vitimas[k]); // os destinos ainda estão todos vivos
+    for (size_t k = 0; k < removidos; k++) retirarVertice(g, vitimas[k]);
+
+    free(vitimas);
+    if (removidos) g->componentes_validas = false;
+    return removidos;
+}
+
+/**
+ * @brief Adiciona uma aresta entre dois vértices no grafo.
+ * 
+ * Esta função cria uma ligação direcionada do vértice de origem para o vértice 
+ * de destino, representando uma aresta na estrutura do grafo. Antes de adicionar,
+ * verifica se ambos os vértices existem e se a aresta já não está presente, 
+ * evitando duplicações. No modo implícito, entre antenas da mesma frequência a
+ * ligação já existe, exceto se tiver sido removida antes (e então é reposta).
+ * 
+ * @param g Ponteiro para o grafo onde a aresta será adicionada.
+ * @param xOrig Coordenada X do vértice de origem.
+ * @param yOrig Coordenada Y do vértice de origem.
+ * @param xDest Coordenada X do vértice de destino.
+ * @param yDest Coordenada Y do vértice de destino.
+ * @param sucesso Ponteiro para variável booleana que indica se a aresta foi adicionada com sucesso.
+ * 
+ * @return Grafo* Ponteiro para o grafo atualizado.
+ */
+
+Grafo* AdicionarAresta(Grafo* g, int xOrig, int yOrig, int xDest, int yDest, bool* sucesso) {
+    *sucesso = false;
+    Vertice* origem = ProcurarVertice(g, xOrig, yOrig); // procura o vertice de origem
+    Vertice* destino = ProcurarVertice(g, xDest, yDest); // procura o destino
+    if (!origem || !destino) return g; // se nao encontrar retorna o grafo
+
+    if (criarLigacao(g, origem, destino)) *sucesso = true; // falha se a aresta já existir
+    return g;
+}
+
+/**
+ * @brief Adiciona um lote de arestas dadas por coordenadas.
+ * 
+ * Cada aresta ocupa quatro inteiros seguidos (xOrig, yOrig, xDest, yDest), o
+ * mesmo formato do ficheiro de GuardarArestasBinario. As extremidades são
+ * procuradas uma vez cada e as arestas são inseridas com inserirArestasEmLote:
+ * as que já existem, as repetidas no lote e as que têm uma extremidade que não
+ * existe no grafo são ignoradas.
+ * 
+ * @param g Ponteiro para o grafo.
+ * @param coordenadas Vetor com 4 * numArestas inteiros.
+ * @param numArestas Número de arestas do lote.
+ * 
+ * @return size_t Número de arestas adicionadas, ou LOTE_SEM_MEMORIA se faltar
+ *         memória (e então nenhuma foi adicionada).
+ */
+
+size_t AdicionarArestasEmLote(Grafo* g, const int* coordenadas, size_t numArestas) {
+    if (!g || !coordenadas || numArestas == 0) return 0;
+    Vertice** pares = malloc(2 * numArestas * sizeof(Vertice*));
+    if (!pares) return LOTE_SEM_MEMORIA;
+    for (size_t k = 0; k < numArestas; k++) {
+        const int* c = coordenadas + 4 * k;
+        pares[2 * k] = ProcurarVertice(g, c[0], c[1]);
+        pares[2 * k + 1] = ProcurarVertice(g, c[2], c[3]);
+        if (!pares[2 * k] || !pares[2 * k + 1]) pares[2 * k] = NULL; // par ignorado
+    }
+    size_t inseridas = inserirLote(g, pares, numArestas, false);
+    free(pares);
+    return inseridas;
+}
+
+/**
+ * @brief Liberta toda a memória associada ao grafo e aos seus vértices.
+ * 
+ * Como vértices, arestas e nós de fila são alocados nos pools do grafo, basta
+ * libertar os slabs de cada pool (custo proporcional ao número de slabs, não
+ * ao número de nós). Finalmente, liberta o índice e a estrutura do grafo.
+ * 
+ * @param g Ponteiro para o grafo a ser destruído.
+ * @param sucesso Ponteiro para variável booleana que indica se a operação foi bem-sucedida.
+ * 
+ * @return NULL Retorna NULL para facilitar a atribuição do ponteiro do grafo a NULL após a destruição.
+ */
+
+Grafo* DestruirGrafo(Grafo* g, bool* sucesso) {
+    *sucesso = false;
+    // vértices, arestas e nós de fila vivem nos slabs dos pools: basta libertar os slabs
+    poolDestruir(&g->pool_vertices);
+    poolDestruir(&g->pool_arestas);
+    poolDestruir(&g->pool_fila);
+    free(g->indice); // liberta a tabela de coordenadas
+    free(g->por_id); // e a tabela de ids
+    free(g->ids_livres);
+    free(g->suprimidas); // e a tabela de ligações suprimidas
+    libertarFilaCircular(&g->fila_bfs);
+    free(g->pilha_dfs);
+    free(g->percurso);
+    for (int f = 0; f < 256; f++) free(g->grupos[f].membros);
+    for (size_t i = 0; i < g->celulas_cap; i++) free(g->celulas[i].membros);
+    free(g->celulas);
+    free(g); // elimina a memoria do grafo removido
+    *sucesso = true;
+    return NULL; //retorna o grafo sem nada
+}
+
+/// @brief Conteúdo de um ficheiro acessível em memória (mapeado ou lido de uma só vez)
+typedef struct ConteudoFicheiro {
+    const char* dados;         ///< Primeiro byte do ficheiro
+    size_t tamanho;            ///< Tamanho do ficheiro em bytes
+    bool mapeado;              ///< true se veio de mmap, false se foi lido para um buffer
+} ConteudoFicheiro;
+
+/**
+ * @brief Torna o conteúdo de um ficheiro acessível em memória.
+ * 
+ * Em sistemas POSIX o ficheiro é mapeado com mmap (só leitura), evitando cópias;
+ * no Windows é lido para um buffer com um único fread.
+ * 
+ * @param nomeFicheiro Nome do ficheiro.
+ * @param c Estrutura a preencher.
+ * 
+ * @return true se o conteúdo ficou disponível, false se não foi possível abrir ou ler.
+ */
+
+static bool abrirConteudoFicheiro(const char* nomeFicheiro, ConteudoFicheiro* c) {
+    c->dados = NULL;
+    c->tamanho = 0;
+    c->mapeado = false;
+#ifndef _WIN32
+    int fd = open(nomeFicheiro, O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return false;
+    }
+    c->tamanho = (size_t)st.st_size;
+    if (c->tamanho > 0) {
+        void* m = mmap(NULL, c->tamanho, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (m == MAP_FAILED) {
+            close(fd);
+            return false;
+        }
+        madvise(m, c->tamanho, MADV_SEQUENTIAL); // vai ser lido do princípio ao fim
+        c->dados = m;
+        c->mapeado = true;
+    }
+    close(fd); // o mapeamento continua válido depois de fechar o descritor
+    return true;
+#else
+    FILE* f = fopen(nomeFicheiro, "rb");
+    if (!f) return false;
+    fseek(f, 0, SEEK_END);
+    long tam = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    if (tam < 0) {
+        fclose(f);
+        return false;
+    }
+    char* buf = malloc(tam > 0 ? (size_t)tam : 1);
+    if (!buf || fread(buf, 1, (size_t)tam, f) != (size_t)tam) {
+        free(buf);
+        fclose(f);
+        return false;
+    }
+    fclose(f);
+    c->dados = buf;
+    c->tamanho = (size_t)tam;
+    return true;
+#endif
+}
+
+/**
+ * @brief Liberta o conteúdo obtido com abrirConteudoFicheiro.
+ * 
+ * @param c Conteúdo a libertar.
+ */
+
+static void fecharConteudoFicheiro(ConteudoFicheiro* c) {
+#ifndef _WIN32
+    if (c->mapeado) munmap((void*)c->dados, c->tamanho);
+    else free((void*)c->dados);
+#else
+    free((void*)c->dados);
+#endif
+    c->dados = NULL;
+    c->tamanho = 0;
+}
+
+/**
+ * @brief Procura o primeiro byte diferente de '.' entre p e fim.
+ * 
+ * Compara 8 bytes de cada vez (SWAR): um XOR com uma palavra cheia de '.' só dá
+ * zero se os 8 bytes forem todos '.', o que permite saltar rapidamente as longas
+ * sequências vazias do mapa. Só quando uma palavra tem algo diferente é que se
+ * procura byte a byte.
+ * 
+ * @param p Início da zona a pesquisar.
+ * @param fim Fim (exclusivo) da zona.
+ * 
+ * @return const char* Posição do primeiro byte diferente de '.', ou fim se não houver.
+ */
+
+static const char* proximoNaoPonto(const char* p, const char* fim) {
+    const uint64_t pontos = 0x2E2E2E2E2E2E2E2EULL; // '.' repetido nos 8 bytes
+    while (fim - p >= 8) {
+        uint64_t palavra;
+        memcpy(&palavra, p, sizeof(palavra)); // leitura sem exigir alinhamento
+        if (palavra ^ pontos) break; // há pelo menos um byte diferente nesta palavra
+        p += 8;
+    }
+    while (p < fim && *p == '.') p++;
+    return p;
+}
+
+/**
+ * @brief Lê um grafo a partir de um ficheiro de texto.
+ * 
+ * O ficheiro é mapeado em memória (ou lido de uma só vez) e percorrido linha a
+ * linha com memchr, saltando os '.' com uma pesquisa de 8 bytes de cada vez.
+ * Cada carácter diferente de '.' cria um vértice na posição (x, y). Um '\r' no
+ * fim da linha (ficheiros com "\r\n") é ignorado.
+ * 
+ * É feita uma primeira passagem só para contar as antenas, de modo a reservar
+ * de uma vez o índice de coordenadas e o pool de vértices; na segunda passagem
+ * os vértices são inseridos diretamente, sem verificar duplicados (cada posição
+ * do ficheiro só aparece uma vez). A ordem de inserção é a mesma de sempre
+ * (linha a linha, da esquerda para a direita).
+ * 
+ * O grafo é criado do zero dentro da função e guarda a largura e a altura do
+ * mapa lido (usadas por deduzirNefastoParalelo para descartar reflexões fora do mapa).
+ * Se o grafo recebido estiver no modo implícito (ativarArestasImplicitas), o
+ * grafo novo também fica, e as antenas da mesma frequência ficam ligadas sem
+ * que seja guardada nenhuma aresta.
+ * 
+ * @param g Ponteiro para o grafo atual (será substituído pelo novo grafo criado).
+ * @param nomeFicheiro Nome do ficheiro de texto a ler.
+ * @param sucesso Ponteiro para variável booleana que indica se a leitura foi bem-sucedida.
+ * 
+ * @return Grafo* Ponteiro para o grafo lido do ficheiro (novo grafo criado).
+ */
+
+Grafo* LerFicheiro(Grafo* g, const char* nomeFicheiro, bool* sucesso) {
+    *sucesso = false;
+    ESTAT_INICIO(t0);
+    ConteudoFicheiro conteudo;
+    if (!abrirConteudoFicheiro(nomeFicheiro, &conteudo)) return g; // retorna o grafo como estava
+
+    Grafo* novo = CriarGrafo(); // cria grafo sem nada
+    if (!novo) {
+        fecharConteudoFicheiro(&conteudo);
+        return g;
+    }
+    novo->arestas_implicitas = g && g->arestas_implicitas; // o modo passa para o grafo lido
+
+    const char* inicio = conteudo.dados;
+    const char* fimFicheiro = conteudo.dados + conteudo.tamanho;
+    bool erro = false;
+
+    for (int passagem = 0; passagem < 2 && !erro; passagem++) {
+        size_t antenas = 0;
+        int y = 0;
+        const char* linha = inicio;
+        while (linha < fimFicheiro && !erro) {
+            const char* fimLinha = memchr(linha, '\n', (size_t)(fimFicheiro - linha));
+            const char* proximaLinha = fimLinha ? fimLinha + 1 : fimFicheiro;
+            if (!fimLinha) fimLinha = fimFicheiro;
+            if (fimLinha > linha && fimLinha[-1] == '\r') fimLinha--; // fim de linha do Windows
+
+            const char* p = proximoNaoPonto(linha, fimLinha);
+            while (p < fimLinha) {
+                if (passagem == 0) {
+                    antenas++;
+                } else if (!criarVertice(novo, (int)(p - linha), y, *p)) {
+                    erro = true;
+                    break;
+                }
+                p = proximoNaoPonto(p + 1, fimLinha);
+            }
+
+            if (passagem == 0 && fimLinha - linha > novo->largura) novo->largura = (int)(fimLinha - linha);
+            y++;
+            linha = proximaLinha;
+        }
+
+        if (passagem == 0) {
+            novo->altura = y;
+            // reserva tudo de uma vez para a segunda passagem
+            if (!indiceReservar(novo, antenas) || !poolReservar(&novo->pool_vertices, antenas)) erro = true;
+        }
+    }
+
+    fecharConteudoFicheiro(&conteudo);
+    if (erro) { // falta de memória a meio: não deixa um grafo incompleto
+        bool destruido;
+        DestruirGrafo(novo, &destruido);
+        return g;
+    }
+    *sucesso = true; //O ficheiro foi lido com sucesso
+    ESTAT_FIM(novo, FASE_LEITURA, t0); // o tempo fica no grafo novo
+    return novo;
+}
+
+/// @brief Dados partilhados pelos fios de execução de deduzirNefastoParalelo
+typedef struct TrabalhoNefasto {
+    const int* xs;             ///< Coordenadas X das antenas, agrupadas por frequência
+    const int* ys;             ///< Coordenadas Y das antenas, agrupadas por frequência
+    const size_t* fimGrupo;    ///< Para cada linha i, fim (exclusivo) do grupo de frequência de i
+    size_t total;              ///< Número de linhas (antenas agrupadas)
+    bool limitar;              ///< Descarta reflexões fora de largura x altura
+    int64_t largura, altura;   ///< Dimensões do mapa usadas quando limitar é true
+    atomic_size_t proxima;     ///< Próxima linha ainda não atribuída a nenhum fio
+    size_t* segInicio;         ///< Início, no buffer do fio, dos candidatos de cada linha
+    size_t* segTam;            ///< Número de candidatos de cada linha
+    int* segFio;               ///< Fio que tratou cada linha
+} TrabalhoNefasto;
+
+/// @brief Estado de cada fio de execução: buffer próprio de candidatos
+typedef struct FioNefasto {
+    TrabalhoNefasto* t;        ///< Trabalho partilhado
+    int indice;                ///< Número do fio
+    uint64_t* buf;             ///< Posições espelhadas encontradas por este fio
+    size_t tam, cap;           ///< Ocupação e capacidade do buffer
+    ConjuntoCoord vistos;      ///< Posições já guardadas por este fio (evita repetir dentro do buffer)
+    bool erro;                 ///< Falha de alocação
+} FioNefasto;
+
+#define LIGAR_PARES_POR_LOTE (1 << 20) ///< Pares que ligarVerticesComMesmaFrequencia junta antes de os inserir
+#define NEFASTO_LINHAS_POR_BLOCO 8 ///< Linhas da matriz de pares que cada fio reserva de uma vez
+
+/**
+ * @brief Trabalho de cada fio: reflete os pares (i, j > i) das linhas que lhe calham.
+ * 
+ * As linhas são distribuídas dinamicamente em blocos por um contador atómico, que
+ * só avança; por isso cada fio trata as suas linhas por ordem crescente. Os
+ * candidatos de cada linha ficam num segmento contíguo do buffer do fio e o
+ * segmento é registado em segInicio/segTam/segFio para a junção final.
+ * 
+ * @param arg Ponteiro para o FioNefasto deste fio.
+ * 
+ * @return NULL
+ */
+
+static void* trabalharNefasto(void* arg) {
+    FioNefasto* fio = arg;
+    TrabalhoNefasto* t = fio->t;
+
+    while (!fio->erro) {
+        size_t primeira = atomic_fetch_add(&t->proxima, NEFASTO_LINHAS_POR_BLOCO);
+        if (primeira >= t->total) break;
+        size_t ultima = primeira + NEFASTO_LINHAS_POR_BLOCO;
+        if (ultima > t->total) ultima = t->total;
+
+        for (size_t i = primeira; i < ultima && !fio->erro; i++) {
+            t->segInicio[i] = fio->tam;
+            t->segFio[i] = fio->indice;
+            for (size_t j = i + 1; j < t->fimGrupo[i] && !fio->erro; j++) {
+                // reflexão de j em torno de i e de i em torno de j (em 64 bits para não transbordar)
+                int64_t espelhos[2][2] = {
+                    { 2 * (int64_t)t->xs[i] - t->xs[j], 2 * (int64_t)t->ys[i] - t->ys[j] },
+                    { 2 * (int64_t)t->xs[j] - t->xs[i], 2 * (int64_t)t->ys[j] - t->ys[i] }
+                };
+                for (int e = 0; e < 2; e++) {
+                    int64_t ex = espelhos[e][0], ey = espelhos[e][1];
+                    if (ex < 0 || ey < 0 || ex > INT32_MAX || ey > INT32_MAX) continue;
+                    if (t->limitar && (ex >= t->largura || ey >= t->altura)) continue; // fora do mapa
+                    uint64_t chave = chaveCoordenadas((int)ex, (int)ey);
+                    int r = conjuntoInserir(&fio->vistos, chave);
+                    if (r < 0) { fio->erro = true; break; }
+                    if (r == 0) continue; // este fio já a encontrou numa linha anterior
+                    if (fio->tam == fio->cap) {
+                        size_t cap = fio->cap ? fio->cap * 2 : 64;
+                        uint64_t* maior = realloc(fio->buf, cap * sizeof(uint64_t));
+                        if (!maior) { fio->erro = true; break; }
+                        fio->buf = maior;
+                        fio->cap = cap;
+                    }
+                    fio->buf[fio->tam++] = chave;
+                }
+            }
+            t->segTam[i] = fio->tam - t->segInicio[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Deduz e adiciona vértices "nefastos" num grafo baseado em reflexões.
+ * 
+ * Versão em série de deduzirNefastoParalelo, sem limite ao tamanho do mapa.
+ * 
+ * @param g Ponteiro para o grafo onde serão adicionados os vértices nefastos.
+ * 
+ * @return bool true se pelo menos um vértice nefasto foi adicionado; false caso contrário.
+ */
+
+bool deduzirNefasto(Grafo* g) {
+    return deduzirNefastoParalelo(g, 1, false);
+}
+
+/**
+ * @brief Deduz os vértices "nefastos" repartindo o trabalho por vários fios de execução.
+ * 
+ * As antenas são primeiro agrupadas por frequência (ordenação por contagem sobre
+ * o carácter da frequência, ignorando '#'), de forma a só comparar pares com a
+ * mesma frequência. Cada antena i define uma linha da matriz de pares (i, j > i)
+ * do seu grupo; cada par dá origem às duas posições espelhadas.
+ * 
+ * As linhas são repartidas por numThreads fios (pthreads), cada um com o seu
+ * buffer de candidatos. No fim, os buffers são percorridos pela ordem das linhas
+ * e as posições são adicionadas ao grafo com frequência '#' numa única passagem,
+ * em que o índice de coordenadas descarta as repetidas e as já ocupadas por
+ * antenas. Como a ordem de junção é a das linhas, o resultado é idêntico
+ * qualquer que seja o número de fios. Com numThreads <= 1 não são criados fios.
+ * 
+ * @param g Ponteiro para o grafo onde serão adicionados os vértices nefastos.
+ * @param numThreads Número de fios de execução a usar.
+ * @param limitarAoMapa Se true, descarta as reflexões fora da largura/altura lidas por
+ *        LerFicheiro (ignorado se essas dimensões forem desconhecidas).
+ * 
+ * @return bool true se pelo menos um vértice nefasto foi adicionado; false caso contrário
+ *         (incluindo falha de alocação, em que o grafo não é alterado).
+ */
+
+bool deduzirNefastoParalelo(Grafo* g, int numThreads, bool limitarAoMapa) {
+    if (!g || g->num_vertices < 2) return false;
+    if (numThreads < 1) numThreads = 1;
+    ESTAT_INICIO(t0);
+
+    // conta quantas antenas há de cada frequência
+    size_t inicioGrupo[257] = {0};
+    size_t total = 0;
+    for (Vertice* v = g->vertices; v != NULL; v = v->prox) {
+        if (v->freq == '#') continue; // os pontos nefastos não geram reflexões
+        inicioGrupo[(unsigned char)v->freq + 1]++;
+        total++;
+    }
+    for (int f = 0; f < 256; f++) inicioGrupo[f + 1] += inicioGrupo[f]; // soma acumulada = início de cada grupo
+    if (total < 2) return false;
+
+    size_t n = total;
+    int* xs = malloc(n * sizeof(int));
+    int* ys = malloc(n * sizeof(int));
+    size_t* fimGrupo = malloc(n * sizeof(size_t));
+    size_t* segInicio = malloc(n * sizeof(size_t));
+    size_t* segTam = calloc(n, sizeof(size_t));
+    int* segFio = calloc(n, sizeof(int));
+    FioNefasto* fios = calloc((size_t)numThreads, sizeof(FioNefasto));
+    bool erro = !xs || !ys || !fimGrupo || !segInicio || !segTam || !segFio || !fios;
+
+    TrabalhoNefasto t;
+    if (!erro) {
+        // distribui as coordenadas pelos grupos, mantendo a ordem da lista dentro de cada grupo
+        size_t proximo[256];
+        memcpy(proximo, inicioGrupo, sizeof(proximo));
+        for (Vertice* v = g->vertices; v != NULL; v = v->prox) {
+            if (v->freq == '#') continue;
+            size_t k = proximo[(unsigned char)v->freq]++;
+            xs[k] = v->x;
+            ys[k] = v->y;
+            fimGrupo[k] = inicioGrupo[(unsigned char)v->freq + 1];
+        }
+
+        t.xs = xs;
+        t.ys = ys;
+        t.fimGrupo = fimGrupo;
+        t.total = n;
+        t.limitar = limitarAoMapa && g->largura > 0 && g->altura > 0;
+        t.largura = g->largura;
+        t.altura = g->altura;
+        atomic_init(&t.proxima, 0);
+        t.segInicio = segInicio;
+        t.segTam = segTam;
+        t.segFio = segFio;
+
+        for (int k = 0; k < numThreads; k++) {
+            fios[k].t = &t;
+            fios[k].indice = k;
+            if (!conjuntoIniciar(&fios[k].vistos, 64)) fios[k].erro = true;
+        }
+
+        if (numThreads == 1) {
+            trabalharNefasto(&fios[0]);
+        } else {
+            pthread_t* ids = malloc((size_t)numThreads * sizeof(pthread_t));
+            bool* criado = calloc((size_t)numThreads, sizeof(bool));
+            if (!ids || !criado) {
+                erro = true;
+            } else {
+                for (int k = 0; k < numThreads; k++) {
+                    criado[k] = pthread_create(&ids[k], NULL, trabalharNefasto, &fios[k]) == 0;
+                }
+                for (int k = 0; k < numThreads; k++) {
+                    if (criado[k]) pthread_join(ids[k], NULL);
+                    else trabalharNefasto(&fios[k]); // se o fio não arrancou, faz o que sobrar aqui
+                }
+            }
+            free(ids);
+            free(criado);
+        }
+        for (int k = 0; k < numThreads; k++) {
+            if (fios[k].erro) erro = true;
+        }
+    }
+
+    // junção: percorre as linhas por ordem e adiciona os candidatos de cada uma
+    bool modificou = false;
+    if (!erro) {
+        for (size_t i = 0; i < n; i++) {
+            FioNefasto* fio = &fios[segFio[i]];
+            for (size_t k = segInicio[i]; k < segInicio[i] + segTam[i]; k++) {
+                bool sucesso;
+                int x = (int)(uint32_t)(fio->buf[k] >> 32);
+                int y = (int)(uint32_t)fio->buf[k];
+                AdicionarVertice(g, x, y, '#', &sucesso); // falha se a posição já estiver ocupada
+                if (sucesso) modificou = true;
+            }
+        }
+    }
+
+    if (fios) {
+        for (int k = 0; k < numThreads; k++) {
+            conjuntoLibertar(&fios[k].vistos);
+            free(fios[k].buf);
+        }
+    }
+    free(fios);
+    free(segFio);
+    free(segTam);
+    free(segInicio);
+    free(fimGrupo);
+    free(xs);
+    free(ys);
+    ESTAT_FIM(g, FASE_NEFASTO, t0);
+    return modificou;
+}
+
+#define LEITOR_BLOCO (1 << 20) ///< Bytes lidos de cada vez pelo LeitorLinhas
+
+/// @brief Leitor de linhas por blocos, para ficheiros que não se querem ter todos em memória
+typedef struct LeitorLinhas {
+    FILE* f;                   ///< Ficheiro em leitura
+    char* buf;                 ///< Buffer com o bloco atual
+    size_t cap;                ///< Capacidade do buffer (cresce se uma linha não couber)
+    size_t ini;                ///< Início da parte ainda não consumida
+    size_t fim;                ///< Fim dos dados válidos no buffer
+    bool eof;                  ///< true quando o ficheiro chegou ao fim
+} LeitorLinhas;
+
+/**
+ * @brief Abre um ficheiro para leitura linha a linha em blocos grandes.
+ * 
+ * @param l Leitor a preparar.
+ * @param nomeFicheiro Nome do ficheiro.
+ * 
+ * @return true se o ficheiro foi aberto e o buffer alocado.
+ */
+
+static bool leitorAbrir(LeitorLinhas* l, const char* nomeFicheiro) {
+    l->f = fopen(nomeFicheiro, "rb");
+    if (!l->f) return false;
+    l->cap = LEITOR_BLOCO;
+    l->buf = malloc(l->cap);
+    l->ini = l->fim = 0;
+    l->eof = false;
+    if (!l->buf) {
+        fclose(l->f);
+        l->f = NULL; // quem chama usa l->f para saber se tem de chamar leitorFechar
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Fecha o ficheiro e liberta o buffer do leitor.
+ * 
+ * @param l Leitor a fechar.
+ */
+
+static void leitorFechar(LeitorLinhas* l) {
+    if (l->f) fclose(l->f);
+    free(l->buf);
+    l->f = NULL;
+    l->buf = NULL;
+}
+
+/**
+ * @brief Devolve a próxima linha do ficheiro, sem o '\n' nem o '\r' final.
+ * 
+ * A linha aponta para dentro do buffer do leitor e só é válida até à próxima chamada.
+ * 
+ * @param l Leitor.
+ * @param linha Recebe o início da linha.
+ * @param tamanho Recebe o comprimento da linha.
+ * @param erro Fica a true se falhar a alocação ao crescer o buffer.
+ * 
+ * @return true se foi devolvida uma linha, false no fim do ficheiro ou em caso de erro.
+ */
+
+static bool leitorLinha(LeitorLinhas* l, const char** linha, size_t* tamanho, bool* erro) {
+    while (true) {
+        char* nl = memchr(l->buf + l->ini, '\n', l->fim - l->ini);
+        if (nl || (l->eof && l->fim > l->ini)) {
+            size_t fimLinha = nl ? (size_t)(nl - l->buf) : l->fim;
+            *linha = l->buf + l->ini;
+            *tamanho = fimLinha - l->ini;
+            if (*tamanho > 0 && (*linha)[*tamanho - 1] == '\r') (*tamanho)--; // fim de linha do Windows
+            l->ini = nl ? fimLinha + 1 : fimLinha;
+            return true;
+        }
+        if (l->eof) return false;
+
+        // a linha continua para além do buffer: desloca o resto para o início e lê mais
+        memmove(l->buf, l->buf + l->ini, l->fim - l->ini);
+        l->fim -= l->ini;
+        l->ini = 0;
+        if (l->fim == l->cap) { // a linha é maior do que o buffer inteiro
+            char* maior = realloc(l->buf, l->cap * 2);
+            if (!maior) {
+                *erro = true;
+                return false;
+            }
+            l->buf = maior;
+            l->cap *= 2;
+        }
+        size_t lidos = fread(l->buf + l->fim, 1, l->cap - l->fim, l->f);
+        l->fim += lidos;
+        if (lidos == 0) l->eof = true;
+    }
+}
+
+/// @brief Coordenadas compactas de uma antena (modo por faixas)
+typedef struct PontoCompacto {
+    int32_t x, y;
+} PontoCompacto;
+
+/**
+ * @brief Primeira posição de um grupo (ordenado por y) com y >= valor.
+ * 
+ * @param pts Pontos do grupo, ordenados por y.
+ * @param n Número de pontos.
+ * @param valor Valor de y procurado.
+ * 
+ * @return size_t Índice da primeira posição com y >= valor (n se não houver).
+ */
+
+static size_t limiteInferiorY(const PontoCompacto* pts, size_t n, int64_t valor) {
+    size_t esq = 0, dir = n;
+    while (esq < dir) {
+        size_t meio = esq + (dir - esq) / 2;
+        if (pts[meio].y < valor) esq = meio + 1;
+        else dir = meio;
+    }
+    return esq;
+}
+
+/**
+ * @brief Avança um cursor de um grupo (ordenado por y) até à primeira posição com y >= valor.
+ * 
+ * @param pts Pontos do grupo, ordenados por y.
+ * @param n Número de pontos.
+ * @param i Posição atual do cursor (todas as anteriores têm y < valor).
+ * @param valor Valor de y procurado.
+ * 
+ * @return size_t Nova posição do cursor (n se não houver).
+ */
+
+static size_t avancarY(const PontoCompacto* pts, size_t n, size_t i, int64_t valor) {
+    while (i < n && pts[i].y < valor) i++;
+    return i;
+}
+
+/**
+ * @brief Deduz os pontos nefastos de um mapa processando-o por faixas horizontais.
+ * 
+ * Alternativa a LerFicheiro + deduzirNefastoParalelo + gerarMatrizGrafo para mapas
+ * que não cabem em memória como grafo. Na primeira leitura guarda-se apenas, para
+ * cada frequência, um vetor compacto de coordenadas (8 bytes por antena, já
+ * ordenado por y porque o ficheiro é lido de cima para baixo).
+ * 
+ * Depois, para cada faixa de alturaFaixa linhas, calculam-se só as reflexões que
+ * lá caem: a reflexão de b em torno de a tem y = 2*a.y - b.y, por isso, para cada
+ * antena a, os b relevantes formam um intervalo contíguo do vetor da frequência.
+ * Os limites desse intervalo só avançam com a, e a janela das antenas a só avança
+ * de faixa para faixa, por isso são mantidos por cursores: cada faixa custa uma
+ * pesquisa binária por frequência mais as antenas da sua janela, sem voltar a
+ * percorrer as anteriores. A faixa original é relida do ficheiro, os '#' são
+ * sobrepostos às posições com '.' e a faixa é escrita no ficheiro de saída.
+ * 
+ * O resultado é o mapa de entrada (com largura igual à da linha mais comprida)
+ * com os pontos nefastos que ficam dentro do mapa, o mesmo que deduzirNefastoParalelo
+ * com limitarAoMapa. A memória usada é proporcional ao número de antenas mais
+ * uma faixa, e não à área do mapa.
+ * 
+ * @param ficheiroEntrada Nome do ficheiro do mapa.
+ * @param ficheiroSaida Nome do ficheiro onde escrever o mapa com os '#'.
+ * @param alturaFaixa Número de linhas de cada faixa (valores < 1 passam a 1).
+ * @param numNefastos Se não for NULL, recebe o número de pontos nefastos escritos.
+ * 
+ * @return true se o mapa foi processado, false em caso de erro de leitura, escrita ou memória.
+ */
+
+bool ProcessarMapaPorFaixas(const char* ficheiroEntrada, const char* ficheiroSaida, int alturaFaixa, size_t* numNefastos) {
+    if (alturaFaixa < 1) alturaFaixa = 1;
+    if (numNefastos) *numNefastos = 0;
+
+    PontoCompacto* grupos[256] = {0};
+    size_t tamGrupo[256] = {0}, capGrupo[256] = {0};
+    size_t largura = 0, altura = 0;
+    bool erro = false;
+
+    // 1ª leitura: recolhe as antenas de cada frequência
+    LeitorLinhas l;
+    if (!leitorAbrir(&l, ficheiroEntrada)) return false;
+    const char* linha;
+    size_t tam;
+    while (!erro && leitorLinha(&l, &linha, &tam, &erro)) {
+        if (tam > largura) largura = tam;
+        const char* p = proximoNaoPonto(linha, linha + tam);
+        while (p < linha + tam) {
+            unsigned char f = (unsigned char)*p;
+            if (f != '#') { // os '#' já existentes não geram reflexões
+                if (tamGrupo[f] == capGrupo[f]) {
+                    size_t cap = capGrupo[f] ? capGrupo[f] * 2 : 64;
+                    PontoCompacto* maior = realloc(grupos[f], cap * sizeof(PontoCompacto));
+                    if (!maior) {
+                        erro = true;
+                        break;
+                    }
+                    grupos[f] = maior;
+                    capGrupo[f] = cap;
+                }
+                grupos[f][tamGrupo[f]].x = (int32_t)(p - linha);
+                grupos[f][tamGrupo[f]].y = (int32_t)altura;
+                tamGrupo[f]++;
+            }
+            p = proximoNaoPonto(p + 1, linha + tam);
+        }
+        altura++;
+    }
+    leitorFechar(&l);
+
+    FILE* saida = NULL;
+    char* faixa = NULL;
+    if (!erro) {
+        faixa = malloc((size_t)alturaFaixa * (largura + 1) + 1);
+        saida = fopen(ficheiroSaida, "wb");
+        if (!faixa || !saida || !leitorAbrir(&l, ficheiroEntrada)) erro = true;
+    }
+
+    // 2ª leitura: faixa a faixa, copia as linhas originais e sobrepõe os '#'
+    size_t aIni[256] = {0}, aFim[256] = {0}; // janela das antenas a de cada frequência, só avança
+    for (size_t y0 = 0; y0 < altura && !erro; y0 += (size_t)alturaFaixa) {
+        size_t y1 = y0 + (size_t)alturaFaixa;
+        if (y1 > altura) y1 = altura;
+
+        for (size_t y = y0; y < y1; y++) {
+            char* destino = faixa + (y - y0) * (largura + 1);
+            if (!leitorLinha(&l, &linha, &tam, &erro)) {
+                erro = true; // o ficheiro mudou entre as duas leituras
+                break;
+            }
+            memcpy(destino, linha, tam);
+            memset(destino + tam, '.', largura - tam); // linhas mais curtas são completadas com '.'
+            destino[largura] = '\n';
+        }
+        if (erro) break;
+
+        for (int f = 0; f < 256; f++) {
+            const PontoCompacto* pts = grupos[f];
+            size_t n = tamGrupo[f];
+            if (n < 2) continue;
+            // a é o ponto médio de b e da reflexão: só as antenas a com y entre
+            // (y0 + menor y)/2 e (y1 - 1 + maior y)/2 podem refletir para esta faixa
+            aIni[f] = avancarY(pts, n, aIni[f], ((int64_t)y0 + pts[0].y) / 2);
+            aFim[f] = avancarY(pts, n, aFim[f], ((int64_t)y1 - 1 + pts[n - 1].y) / 2 + 1);
+            if (aIni[f] >= aFim[f]) continue;
+            // b.y tem de estar em (2*a.y - y1, 2*a.y - y0]: os dois limites só crescem com a
+            size_t bIni = limiteInferiorY(pts, n, 2 * (int64_t)pts[aIni[f]].y - (int64_t)y1 + 1);
+            size_t bFim = bIni;
+            for (size_t a = aIni[f]; a < aFim[f]; a++) {
+                bIni = avancarY(pts, n, bIni, 2 * (int64_t)pts[a].y - (int64_t)y1 + 1);
+                bFim = avancarY(pts, n, bFim, 2 * (int64_t)pts[a].y - (int64_t)y0 + 1);
+                for (size_t b = bIni; b < bFim; b++) {
+                    if (b == a) continue;
+                    int64_t ex = 2 * (int64_t)pts[a].x - pts[b].x;
+                    int64_t ey = 2 * (int64_t)pts[a].y - pts[b].y;
+                    if (ex < 0 || ex >= (int64_t)largura) continue;
+                    char* celula = faixa + ((size_t)ey - y0) * (largura + 1) + (size_t)ex;
+                    if (*celula == '.') { // não substitui antenas nem '#' já marcados
+                        *celula = '#';
+                        if (numNefastos) (*numNefastos)++;
+                    }
+                }
+            }
+        }
+
+        size_t bytes = (y1 - y0) * (largura + 1);
+        if (fwrite(faixa, 1, bytes, saida) != bytes) erro = true;
+    }
+
+    if (l.f) leitorFechar(&l);
+    if (saida && fclose(saida) != 0) erro = true;
+    free(faixa);
+    for (int f = 0; f < 256; f++) free(grupos[f]);
+    return !erro;
+}
+
+/**
+ * @brief Garante espaço livre no buffer de um escritor.
+ * 
+ * Num escritor com destino despeja o buffer; num escritor em memória faz crescer
+ * o buffer. Cada linha é escrita depois de reservar o seu tamanho máximo, para que
+ * os dígitos possam ser postos diretamente no buffer.
+ * 
+ * @param e Escritor.
+ * @param n Bytes que vão ser escritos (no máximo ESCRITOR_BUFFER).
+ * 
+ * @return true se há n bytes livres, false se falhar a escrita ou a alocação.
+ */
+
+static bool escritorReservar(EscritorSaida* e, size_t n) {
+    if (e->capacidade - e->usados >= n) return true;
+    if (!e->memoria) return despejarEscritor(e) && e->capacidade - e->usados >= n;
+    size_t cap = e->capacidade * 2;
+    while (cap - e->usados < n) cap *= 2;
+    char* maior = realloc(e->buffer, cap);
+    if (!maior) {
+        e->erro = true;
+        return false;
+    }
+    e->buffer = maior;
+    e->capacidade = cap;
+    return true;
+}
+
+/// @brief Pares de dígitos "00" a "99", para converter inteiros dois dígitos de cada vez
+static const char paresDigitos[201] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+#define ESCRITOR_MAX_INTEIRO 11 ///< Caracteres de um int em texto, no pior caso ("-2147483648")
+
+/**
+ * @brief Escreve um inteiro em decimal, como o "%d" do printf.
+ * 
+ * @param p Onde escrever (com pelo menos ESCRITOR_MAX_INTEIRO bytes livres).
+ * @param valor Inteiro a escrever.
+ * 
+ * @return char* Posição a seguir ao último dígito.
+ */
+
+static char* escreverInteiro(char* p, int valor) {
+    uint32_t u = (uint32_t)valor;
+    if (valor < 0) {
+        *p++ = '-';
+        u = 0u - u; // também funciona para INT_MIN
+    }
+    char tmp[10];
+    int n = 0;
+    while (u >= 100) {
+        uint32_t par = (u % 100) * 2;
+        u /= 100;
+        tmp[n++] = paresDigitos[par + 1];
+        tmp[n++] = paresDigitos[par];
+    }
+    if (u >= 10) {
+        tmp[n++] = paresDigitos[u * 2 + 1];
+        tmp[n++] = paresDigitos[u * 2];
+    } else {
+        tmp[n++] = (char)('0' + u);
+    }
+    while (n > 0) *p++ = tmp[--n];
+    return p;
+}
+
+#define ESCRITOR_MAX_ANTENA (2 * ESCRITOR_MAX_INTEIRO + 6) ///< Tamanho máximo de "c(x, y) "
+
+/**
+ * @brief Escreve uma antena no formato "c(x, y) ", usado pelas listagens de vizinhos.
+ * 
+ * @param p Onde escrever (com pelo menos ESCRITOR_MAX_ANTENA bytes livres).
+ * @param freq Frequência da antena.
+ * @param x Coordenada X.
+ * @param y Coordenada Y.
+ * 
+ * @return char* Posição a seguir ao último caractere.
+ */
+
+static char* escreverVizinho(char* p, char freq, int x, int y) {
+    *p++ = freq;
+    *p++ = '(';
+    p = escreverInteiro(p, x);
+    *p++ = ',';
+    *p++ = ' ';
+    p = escreverInteiro(p, y);
+    *p++ = ')';
+    *p++ = ' ';
+    return p;
+}
+
+/// @brief Tamanho máximo de "Antena (x, y) [c] -> ": "Antena (" + x + ", " + y + ") [" + c + "] -> "
+#define ESCRITOR_MAX_CABECA (2 * ESCRITOR_MAX_INTEIRO + 19)
+
+/**
+ * @brief Escreve o início de uma linha de listagem: "Antena (x, y) [c] -> ".
+ * 
+ * @param e Escritor.
+ * @param x Coordenada X.
+ * @param y Coordenada Y.
+ * @param freq Frequência da antena.
+ * 
+ * @return true se foi escrito, false se falhar a escrita.
+ */
+
+static bool escreverCabecaAntena(EscritorSaida* e, int x, int y, char freq) {
+    if (!escritorReservar(e, ESCRITOR_MAX_CABECA)) return false;
+    char* p = e->buffer + e->usados;
+    memcpy(p, "Antena (", 8);
+    p = escreverInteiro(p + 8, x);
+    *p++ = ',';
+    *p++ = ' ';
+    p = escreverInteiro(p, y);
+    memcpy(p, ") [", 3);
+    p[3] = freq;
+    memcpy(p + 4, "] -> ", 5);
+    e->usados = (size_t)(p + 9 - e->buffer);
+    return true;
+}
+
+/**
+ * @brief Liga um escritor a um FILE* já aberto.
+ * 
+ * O texto é guardado no buffer do escritor e passado ao FILE* com um fwrite por
+ * cada ESCRITOR_BUFFER bytes. O FILE* não é fechado por fecharEscritor.
+ * 
+ * @param e Escritor a preparar.
+ * @param f Ficheiro de destino (pode ser stdout).
+ * 
+ * @return true se o escritor está pronto, false se os argumentos forem inválidos ou falhar a alocação.
+ */
+
+bool escritorFicheiro(EscritorSaida* e, FILE* f) {
+    if (!e || !f) return false;
+    e->buffer = malloc(ESCRITOR_BUFFER);
+    if (!e->buffer) return false;
+    e->usados = 0;
+    e->capacidade = ESCRITOR_BUFFER;
+    e->ficheiro = f;
+    e->fd = -1;
+    e->memoria = false;
+    e->erro = false;
+    return true;
+}
+
+/**
+ * @brief Liga um escritor a um descritor de ficheiro já aberto.
+ * 
+ * O texto é despejado com write(), sem passar pelo stdio. O descritor não é
+ * fechado por fecharEscritor. Não disponível em Windows.
+ * 
+ * @param e Escritor a preparar.
+ * @param fd Descritor de destino.
+ * 
+ * @return true se o escritor está pronto, false se os argumentos forem inválidos ou falhar a alocação.
+ */
+
+bool escritorDescritor(EscritorSaida* e, int fd) {
+#ifndef _WIN32
+    if (!e || fd < 0) return false;
+    e->buffer = malloc(ESCRITOR_BUFFER);
+    if (!e->buffer) return false;
+    e->usados = 0;
+    e->capacidade = ESCRITOR_BUFFER;
+    e->ficheiro = NULL;
+    e->fd = fd;
+    e->memoria = false;
+    e->erro = false;
+    return true;
+#else
+    (void)e;
+    (void)fd;
+    return false;
+#endif
+}
+
+/**
+ * @brief Prepara um escritor que guarda todo o texto em memória.
+ * 
+ * O buffer cresce para o dobro sempre que enche. O texto é obtido com
+ * retirarTextoEscritor.
+ * 
+ * @param e Escritor a preparar.
+ * 
+ * @return true se o escritor está pronto, false se o ponteiro for NULL ou falhar a alocação.
+ */
+
+bool escritorMemoria(EscritorSaida* e) {
+    if (!e) return false;
+    e->buffer = malloc(4096);
+    if (!e->buffer) return false;
+    e->usados = 0;
+    e->capacidade = 4096;
+    e->ficheiro = NULL;
+    e->fd = -1;
+    e->memoria = true;
+    e->erro = false;
+    return true;
+}
+
+/**
+ * @brief Passa ao destino o texto que está no buffer do escritor.
+ * 
+ * No modo de memória não faz nada (o texto fica no buffer).
+ * 
+ * @param e Escritor.
+ * 
+ * @return true se não houve nenhum erro até agora, false caso contrário.
+ */
+
+bool despejarEscritor(EscritorSaida* e) {
+    if (!e || !e->buffer) return false;
+    if (e->memoria || e->usados == 0) return !e->erro;
+    if (e->ficheiro) {
+        if (fwrite(e->buffer, 1, e->usados, e->ficheiro) != e->usados) e->erro = true;
+    }
+#ifndef _WIN32
+    else {
+        size_t feito = 0;
+        while (feito < e->usados) {
+            ssize_t n = write(e->fd, e->buffer + feito, e->usados - feito);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) {
+                e->erro = true;
+                break;
+            }
+            feito += (size_t)n;
+        }
+    }
+#endif
+    e->usados = 0;
+    return !e->erro;
+}
+
+/**
+ * @brief Despeja o que falta e liberta o buffer do escritor.
+ * 
+ * O FILE* ou o descritor de destino continuam abertos. No modo de memória o
+ * texto que não tenha sido retirado é perdido.
+ * 
+ * @param e Escritor.
+ * 
+ * @return true se todo o texto foi escrito sem erros, false caso contrário.
+ */
+
+bool fecharEscritor(EscritorSaida* e) {
+    if (!e || !e->buffer) return false;
+    bool ok = despejarEscritor(e);
+    free(e->buffer);
+    e->buffer = NULL;
+    e->usados = 0;
+    e->capacidade = 0;
+    return ok;
+}
+
+/**
+ * @brief Retira o texto de um escritor em memória e fecha-o.
+ * 
+ * @param e Escritor preparado com escritorMemoria.
+ * @param tamanho Recebe o comprimento do texto, sem o '\0' (pode ser NULL).
+ * 
+ * @return char* Texto terminado em '\0' (a libertar pelo chamador), ou NULL se o
+ *         escritor não for de memória ou tiver havido algum erro.
+ */
+
+char* retirarTextoEscritor(EscritorSaida* e, size_t* tamanho) {
+    if (!e || !e->buffer || !e->memoria) return NULL;
+    if (e->erro || (e->usados == e->capacidade && !escritorReservar(e, 1))) {
+        fecharEscritor(e);
+        return NULL;
+    }
+    char* texto = e->buffer;
+    texto[e->usados] = '\0';
+    if (tamanho) *tamanho = e->usados;
+    e->buffer = NULL;
+    e->usados = 0;
+    e->capacidade = 0;
+    return texto;
+}
+
+/**
+ * @brief Lista todas as antenas do grafo e as suas conexões (arestas).
+ * 
+ * Esta função percorre todos os vértices do grafo, imprime as coordenadas e a frequência
+ * de cada antena, seguido das antenas ligadas a ela (arestas). Além disso, conta o número
+ * total de antenas existentes no grafo. O texto é escrito no stdout através de um
+ * EscritorSaida (ver listarAntenasEscritor).
+ * 
+ * @param g Ponteiro para o grafo contendo as antenas.
+ * @param contador Ponteiro para um inteiro onde será armazenado o número total de antenas.
+ * 
+ * @return Vertice* Ponteiro para o primeiro vértice da lista do grafo, ou NULL se
+ *         falhar a alocação do buffer de escrita.
+ */
+
+ Vertice* listarAntenas(Grafo* g, int* contador){
+    if (!g || !contador) return NULL; // o grafo ou o ponteiro contador não foram passados (são NULL).
+
+    EscritorSaida e; // o texto vai para o stdout em blocos grandes, em vez de um printf por antena
+    if (!escritorFicheiro(&e, stdout)) return NULL;
+    listarAntenasEscritor(g, &e, contador);
+    fecharEscritor(&e);
+
+    return g->vertices; //retorna o ponteiro para o primeiro vértice da lista de vértices.
+}
+
+/**
+ * @brief Lista as antenas do grafo e as suas conexões para um escritor.
+ * 
+ * Escreve exatamente o mesmo texto que listarAntenas, mas para qualquer destino
+ * de um EscritorSaida (ficheiro, descritor ou memória). Os números são convertidos
+ * à mão diretamente para o buffer do escritor, sem passar pelo printf.
+ * O escritor não é fechado.
+ * 
+ * @param g Ponteiro para o grafo contendo as antenas.
+ * @param e Escritor de destino.
+ * @param contador Ponteiro para um inteiro onde será armazenado o número total de antenas.
+ * 
+ * @return true se todo o texto foi escrito, false se os argumentos forem inválidos ou falhar a escrita.
+ */
+
+bool listarAntenasEscritor(Grafo* g, EscritorSaida* e, int* contador) {
+    if (!g || !e || !e->buffer || !contador) return false;
+
+    *contador = 0;
+    for (Vertice* v = g->vertices; v != NULL; v = v->prox) {
+        if (!escreverCabecaAntena(e, v->x, v->y, v->freq)) return false;
+        IteradorVizinhos it; // percorre as arestas (e, no modo implícito, o grupo de frequência)
+        iniciarVizinhos(&it, v);
+        for (Vertice* d = proximoVizinho(&it); d != NULL; d = proximoVizinho(&it)) {
+            if (!escritorReservar(e, ESCRITOR_MAX_ANTENA)) return false;
+            e->usados = (size_t)(escreverVizinho(e->buffer + e->usados, d->freq, d->x, d->y) - e->buffer);
+        }
+        if (!escritorReservar(e, 1)) return false;
+        e->buffer[e->usados++] = '\n';
+        (*contador)++;
+    }
+    return !e->erro;
+}
+
+/**
+ * @brief Guarda o grafo num ficheiro de texto.
+ *
+ * Esta função cria uma matriz bidimensional representando as antenas
  * presentes no grafo, usando as suas coordenadas (x,y) para posicioná-las.
  * Cada célula da matriz representa uma posição no plano. As antenas são
  * representadas pelo seu caractere de frequência. As posições sem antenas
  * são preenchidas com '.'.
  * 
- * O conteúdo da matriz é escrito num ficheiro de texto com o nome especificado,
- * onde cada linha corresponde a uma linha da matriz.
- *
- * @param g Ponteiro para o grafo a guardar.
- * @param nomeFicheiro Nome do ficheiro onde o grafo será guardado.
- *
- * @return true se o grafo foi guardado com sucesso, false caso contrário
- *         (por exemplo, erro na alocação de memória ou abertura do ficheiro).
+ * O conteúdo da matriz é escrito num ficheiro de texto com o nome especificado,
+ * onde cada linha corresponde a uma linha da matriz. A escrita é feita por
+ * guardarGrafoEscritor, em blocos de ESCRITOR_BUFFER bytes.
+ *
+ * @param g Ponteiro para o grafo a guardar.
+ * @param nomeFicheiro Nome do ficheiro onde o grafo será guardado.
+ *
+ * @return true se o grafo foi guardado com sucesso, false caso contrário
+ *         (por exemplo, erro na alocação de memória ou abertura do ficheiro).
+ */
+
+bool guardarGrafo(Grafo* g, const char* nomeFicheiro) {
+    if (!g) return false;
+
+    FILE* f = fopen(nomeFicheiro, "w");
+    if (!f) return false;
+
+    EscritorSaida e = { 0 };
+    bool ok = escritorFicheiro(&e, f) && guardarGrafoEscritor(g, &e);
+    if (e.buffer && !fecharEscritor(&e)) ok = false;
+    if (fclose(f) != 0) ok = false;
+    return ok;
+}
+
+/**
+ * @brief Escreve os vértices do grafo num escritor, no formato de guardarGrafo.
+ * 
+ * Cada vértice dá uma linha "x y freq". O escritor não é fechado.
+ * 
+ * @param g Ponteiro para o grafo a guardar.
+ * @param e Escritor de destino.
+ * 
+ * @return true se todo o texto foi escrito, false se os argumentos forem inválidos ou falhar a escrita.
+ */
+
+bool guardarGrafoEscritor(Grafo* g, EscritorSaida* e) {
+    if (!g || !e || !e->buffer) return false;
+
+    for (Vertice* v = g->vertices; v != NULL; v = v->prox) {
+        // Exemplo de formato: x y freq
+        if (!escritorReservar(e, 2 * ESCRITOR_MAX_INTEIRO + 4)) return false;
+        char* p = escreverInteiro(e->buffer + e->usados, v->x);
+        *p++ = ' ';
+        p = escreverInteiro(p, v->y);
+        *p++ = ' ';
+        *p++ = v->freq;
+        *p++ = '\n';
+        e->usados = (size_t)(p - e->buffer);
+    }
+    return !e->erro;
+}
+
+/**
+ * @brief Procura um vértice no grafo pelo seu identificador único.
+ * 
+ * Consulta diretamente a tabela densa de ids do grafo, em O(1).
+ * 
+ * @param g Ponteiro para o grafo onde a procura será realizada.
+ * @param id Identificador único do vértice a encontrar.
+ * 
+ * @return Ponteiro para o vértice com o id correspondente, ou NULL se não existir.
+ */
+
+Vertice* encontrarVerticePorID(Grafo* g, int id) {
+    if (!g || id < 0 || id >= g->por_id_cap) return NULL;
+    return g->por_id[id];
+}
+
+/**
+ * @brief Renumera os vértices com ids seguidos, de 0 a num_vertices - 1.
+ * 
+ * Depois de muitas remoções os ids podem ficar espalhados (com a tabela de ids
+ * maior do que o necessário). A compactação mantém a ordem relativa dos ids,
+ * esvazia a pilha de ids livres e reduz a tabela. Os ids guardados fora do
+ * grafo (por exemplo, em ficheiros de GuardarArestasPorID ou em instantâneos)
+ * deixam de corresponder aos vértices.
+ * 
+ * @param g Ponteiro para o grafo.
+ * 
+ * @return true se os ids foram compactados, false se o grafo for NULL.
+ */
+
+bool compactarIds(Grafo* g) {
+    if (!g) return false;
+    int seguinte = 0;
+    for (int id = 0; id < g->proximo_id; id++) { // como seguinte <= id, pode ser feito no mesmo vetor
+        Vertice* v = g->por_id[id];
+        if (!v) continue;
+        g->por_id[id] = NULL;
+        v->id = seguinte;
+        g->por_id[seguinte++] = v;
+    }
+    g->proximo_id = seguinte;
+    g->ids_livres_tam = 0;
+    if (g->por_id_cap > 16 && seguinte < g->por_id_cap / 4) { // liberta a parte que ficou sem uso
+        int cap = seguinte > 16 ? seguinte : 16;
+        Vertice** menor = realloc(g->por_id, (size_t)cap * sizeof(Vertice*));
+        if (menor) {
+            g->por_id = menor;
+            g->por_id_cap = cap;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Insere uma aresta da origem para o destino no grafo.
+ * 
+ * Adiciona uma aresta na lista de adjacência do vértice de origem
+ * que aponta para o vértice de destino, evitando duplicatas.
+ * 
+ * @param origem Ponteiro para o vértice de origem.
+ * @param destino Ponteiro para o vértice de destino.
+ * 
+ * @return true se a aresta foi inserida com sucesso, false caso contrário
+ *         (por exemplo, se a aresta já existir ou falha na alocação).
+ */
+
+bool inserirAresta(Vertice* origem, Vertice* destino) {
+    if (!origem || !destino) return false;
+    return criarLigacao(origem->dono, origem, destino); // evita duplicadas e atualiza as componentes
+}
+
+/**
+ * @brief Insere um lote de arestas entre vértices do grafo.
+ * 
+ * Equivale a chamar inserirAresta para cada par, pela mesma ordem, mas agrupa
+ * os pares por origem e elimina os duplicados de uma só vez: a lista de cada
+ * origem é percorrida uma vez por lote, e não a cada inserção. O custo é
+ * O(P + soma dos graus das origens do lote). O lote é inserido por completo ou
+ * não é inserido de todo.
+ * 
+ * @param g Ponteiro para o grafo a que os vértices pertencem.
+ * @param pares Vetor com 2 * numPares vértices: pares[2k] é a origem e pares[2k + 1] o destino.
+ * @param numPares Número de pares.
+ * 
+ * @return size_t Número de arestas inseridas, ou LOTE_SEM_MEMORIA se faltar
+ *         memória (e então nenhuma foi inserida).
+ */
+
+size_t inserirArestasEmLote(Grafo* g, Vertice** pares, size_t numPares) {
+    if (!g || !pares) return 0;
+    return inserirLote(g, pares, numPares, false);
+}
+
+/**
+ * @brief Remove a aresta da origem para o destino no grafo.
+ * 
+ * Procura e remove a aresta que conecta o vértice origem ao vértice destino
+ * na lista de adjacência do vértice origem.
+ * 
+ * @param origem Ponteiro para o vértice de origem.
+ * @param destino Ponteiro para o vértice de destino.
+ * 
+ * @return true se a aresta foi encontrada e removida, false caso contrário.
+ */
+
+bool removerAresta(Vertice* origem, Vertice* destino) {
+    if (!origem || !destino) return false;
+    return cortarLigacao(origem->dono, origem, destino);
+}
+
+/**
+ * @brief Insere um lote de ligarMesmaFrequencia e soma as arestas criadas.
+ * 
+ * @param g Ponteiro para o grafo.
+ * @param pares Pares do lote.
+ * @param numPares Número de pares.
+ * @param novos Ver inserirLote.
+ * @param criadas Acumula o número de arestas criadas.
+ * 
+ * @return true se o lote foi inserido, false se faltou memória (e nada foi inserido).
+ */
+
+static bool juntarLote(Grafo* g, Vertice** pares, size_t numPares, bool novos, size_t* criadas) {
+    size_t n = inserirLote(g, pares, numPares, novos);
+    if (n == LOTE_SEM_MEMORIA) return false;
+    *criadas += n;
+    return true;
+}
+
+/**
+ * @brief Liga vértices que têm a mesma frequência no grafo e conta as arestas criadas.
+ * 
+ * Cria arestas bidirecionais entre os vértices que possuem a mesma frequência,
+ * desde que a frequência não seja '#' ou '.'. Os vértices são primeiro
+ * separados por frequência (O(V)), e os pares de cada frequência são inseridos
+ * em lotes com inserirArestasEmLote, que elimina os duplicados sem percorrer as
+ * listas a cada aresta. Nas frequências em que nenhum vértice tem ainda arestas
+ * de saída (o caso normal) nem essa verificação é feita, e o custo é O(V + E);
+ * nas outras cada lote percorre as listas das suas origens uma vez. As listas ficam pela mesma ordem que teriam com
+ * inserirAresta par a par, e as componentes ligadas (componenteDe,
+ * mesmaComponente, ...) ficam calculadas ao mesmo tempo.
+ * 
+ * No modo implícito (ativarArestasImplicitas) não faz nada, porque essas
+ * ligações já são dadas pelos grupos de frequência.
+ * 
+ * Cada lote é inserido por completo ou não é inserido. Se faltar memória, a
+ * função para no lote que falhou: os lotes anteriores ficam no grafo e é
+ * devolvido LOTE_SEM_MEMORIA, que se distingue de 0 (nenhuma aresta nova).
+ * 
+ * @param g Ponteiro para o grafo.
+ * 
+ * @return size_t Número de arestas novas, ou LOTE_SEM_MEMORIA se faltar memória.
+ */
+
+size_t ligarMesmaFrequencia(Grafo* g) {
+    if (!g || g->arestas_implicitas) return 0; // as ligações já existem através dos grupos de frequência
+    ESTAT_INICIO(t0);
+
+    // junta os vértices de cada frequência pela ordem da lista
+    size_t inicioFreq[257] = { 0 };
+    for (Vertice* v = g->vertices; v != NULL; v = v->prox) inicioFreq[(unsigned char)v->freq + 1]++;
+    for (int f = 0; f < 256; f++) inicioFreq[f + 1] += inicioFreq[f];
+    size_t totalPares = 0; // pares dirigidos a criar, para não reservar mais do que um lote precisa
+    for (int f = 0; f < 256; f++) {
+        size_t k = inicioFreq[f + 1] - inicioFreq[f];
+        if (frequenciaLigavel((char)f) && k > 1) totalPares += k * (k - 1);
+    }
+    if (totalPares == 0) return 0;
+    size_t capLote = totalPares < LIGAR_PARES_POR_LOTE ? totalPares : LIGAR_PARES_POR_LOTE;
+
+    Vertice** porFreq = malloc((size_t)g->num_vertices * sizeof(Vertice*));
+    Vertice** pares = malloc(2 * capLote * sizeof(Vertice*));
+    if (!porFreq || !pares) {
+        free(porFreq);
+        free(pares);
+        return LOTE_SEM_MEMORIA;
+    }
+    size_t cursor[256];
+    memcpy(cursor, inicioFreq, sizeof(cursor));
+    for (Vertice* v = g->vertices; v != NULL; v = v->prox) porFreq[cursor[(unsigned char)v->freq]++] = v;
+
+    // uma frequência cujos vértices ainda não têm arestas de saída dá uma clique
+    // nova: nenhum dos seus pares pode já existir, e inserirLote não os verifica
+    bool nova[256];
+    for (int f = 0; f < 256; f++) {
+        nova[f] = true;
+        for (size_t i = inicioFreq[f]; i < inicioFreq[f + 1] && nova[f]; i++) {
+            if (porFreq[i]->arestas) nova[f] = false;
+        }
+    }
+
+    // cada par (v1, v2), com v1 antes de v2 na lista, dá v1 -> v2 e v2 -> v1, como antes
+    size_t criadas = 0;
+    bool semMemoria = false;
+    size_t usados = 0;
+    bool loteNovo = false; // um lote só junta pares de frequências do mesmo tipo (nova ou não)
+    for (int f = 0; f < 256 && !semMemoria; f++) {
+        if (!frequenciaLigavel((char)f) || inicioFreq[f + 1] - inicioFreq[f] < 2) continue;
+        if (usados && nova[f] != loteNovo) {
+            semMemoria = !juntarLote(g, pares, usados, loteNovo, &criadas);
+            usados = 0;
+        }
+        loteNovo = nova[f];
+        for (size_t i = inicioFreq[f]; i < inicioFreq[f + 1] && !semMemoria; i++) {
+            for (size_t j = i + 1; j < inicioFreq[f + 1] && !semMemoria; j++) {
+                pares[2 * usados] = porFreq[i];
+                pares[2 * usados + 1] = porFreq[j];
+                pares[2 * usados + 2] = porFreq[j];
+                pares[2 * usados + 3] = porFreq[i];
+                usados += 2;
+                if (usados + 2 > capLote) { // lote cheio: insere e recomeça
+                    semMemoria = !juntarLote(g, pares, usados, loteNovo, &criadas);
+                    usados = 0;
+                }
+            }
+        }
+    }
+    if (usados && !semMemoria) semMemoria = !juntarLote(g, pares, usados, loteNovo, &criadas);
+
+    free(porFreq);
+    free(pares);
+    if (semMemoria) return LOTE_SEM_MEMORIA;
+    ESTAT_FIM(g, FASE_LIGACAO, t0);
+    return criadas;
+}
+
+/**
+ * @brief Liga vértices que têm a mesma frequência no grafo.
+ * 
+ * Cria arestas bidirecionais entre os vértices que possuem a mesma frequência,
+ * desde que a frequência não seja '#' ou '.'. É ligarMesmaFrequencia com o
+ * resultado antigo; quem precisar de distinguir a falta de memória de "nenhuma
+ * aresta nova" deve usar ligarMesmaFrequencia.
+ * 
+ * @param g Ponteiro para o grafo.
+ * 
+ * @return true se pelo menos uma nova aresta foi adicionada, false caso contrário.
+ */
+
+bool ligarVerticesComMesmaFrequencia(Grafo* g) {
+    size_t criadas = ligarMesmaFrequencia(g);
+    return criadas != 0 && criadas != LOTE_SEM_MEMORIA;
+}
+
+/**
+ * @brief Passa o grafo para o modo de ligações implícitas entre antenas da mesma frequência.
+ * 
+ * Em vez de guardar uma aresta para cada par de antenas com a mesma frequência
+ * (O(k²) nós por frequência), as travessias e a listagem obtêm esses vizinhos
+ * diretamente do grupo da frequência. As listas de arestas passam a guardar só
+ * as alterações feitas à mão: AdicionarAresta/inserirAresta entre frequências
+ * diferentes, e as ligações implícitas removidas com RemoverAresta/removerAresta
+ * (na lista de suprimidas de cada vértice e na tabela Grafo::suprimidas).
+ * 
+ * Ativar o modo equivale a ligarVerticesComMesmaFrequencia: todas as antenas
+ * da mesma frequência passam a estar ligadas, e as arestas já guardadas entre
+ * elas são apagadas, por ficarem repetidas. Só as remoções feitas depois ficam
+ * registadas como suprimidas. Num grafo vazio a ativação é O(1), e LerFicheiro
+ * mantém o modo do grafo que recebe, por isso um mapa pode ser lido diretamente
+ * no modo implícito. As frequências '#' e '.' continuam sem ligações implícitas.
+ * 
+ * @param g Ponteiro para o grafo.
+ * 
+ * @return true se o grafo ficou no modo implícito, false se o ponteiro for NULL.
+ */
+
+bool ativarArestasImplicitas(Grafo* g) {
+    if (!g) return false;
+    if (g->arestas_implicitas) return true;
+
+    for (Vertice* v = g->vertices; v != NULL; v = v->prox) {
+        if (!frequenciaLigavel(v->freq)) continue;
+        Aresta* a = v->arestas;
+        while (a) {
+            Aresta* seguinte = a->prox;
+            if (a->destino->freq == v->freq && a->destino != v) desligarNo(&v->arestas, a, &g->pool_arestas); // passa a ser implícita
+            a = seguinte;
+        }
+        a = v->entradas; // e as entradas correspondentes, que são as da mesma frequência
+        while (a) {
+            Aresta* seguinte = a->prox;
+            if (a->destino->freq == v->freq && a->destino != v) desligarNo(&v->entradas, a, &g->pool_arestas);
+            a = seguinte;
+        }
+    }
+
+    g->arestas_implicitas = true;
+    for (int f = 0; f < 256 && g->componentes_validas; f++) { // cada grupo passa a ser uma só componente
+        GrupoFrequencia* grupo = &g->grupos[f];
+        if (!frequenciaLigavel((char)f)) continue;
+        for (int i = 1; i < grupo->tamanho; i++) ufUnir(grupo->membros[0], grupo->membros[i]);
+    }
+    return true;
+}
+
+/**
+ * @brief Devolve o representante da componente ligada de um vértice.
+ * 
+ * As componentes são mantidas por uma estrutura union-find (compressão de
+ * caminho e união por rank) atualizada sempre que uma aresta é criada
+ * (AdicionarAresta, inserirAresta e, portanto, ligarVerticesComMesmaFrequencia).
+ * As arestas contam nos dois sentidos, ou seja, são componentes fracamente
+ * ligadas. Se tiver havido remoções desde a última consulta, as componentes são
+ * recalculadas primeiro.
+ * 
+ * @param g Ponteiro para o grafo.
+ * @param v Vértice do grafo.
+ * 
+ * @return Vertice* Vértice raiz da componente, ou NULL se algum ponteiro for NULL.
+ */
+
+Vertice* componenteDe(Grafo* g, Vertice* v) {
+    if (!g || !v) return NULL;
+    if (!g->componentes_validas) reconstruirComponentes(g);
+    return ufRaiz(v);
+}
+
+/**
+ * @brief Devolve o identificador da componente da antena em (x, y).
+ * 
+ * O identificador é o id do vértice raiz da componente, pelo que duas antenas
+ * estão ligadas se e só se tiverem o mesmo identificador (até à próxima alteração).
+ * 
+ * @param g Ponteiro para o grafo.
+ * @param x Coordenada X.
+ * @param y Coordenada Y.
+ * 
+ * @return int Identificador da componente, ou -1 se a antena não existir.
+ */
+
+int idComponente(Grafo* g, int x, int y) {
+    if (!g) return -1;
+    Vertice* raiz = componenteDe(g, ProcurarVertice(g, x, y));
+    return raiz ? raiz->id : -1;
+}
+
+/**
+ * @brief Indica se duas antenas estão na mesma componente ligada.
+ * 
+ * @param g Ponteiro para o grafo.
+ * @param x1 Coordenada X da primeira antena.
+ * @param y1 Coordenada Y da primeira antena.
+ * @param x2 Coordenada X da segunda antena.
+ * @param y2 Coordenada Y da segunda antena.
+ * 
+ * @return true se ambas existirem e estiverem ligadas, false caso contrário.
+ */
+
+bool mesmaComponente(Grafo* g, int x1, int y1, int x2, int y2) {
+    if (!g) return false;
+    Vertice* a = componenteDe(g, ProcurarVertice(g, x1, y1));
+    Vertice* b = componenteDe(g, ProcurarVertice(g, x2, y2));
+    return a && a == b;
+}
+
+/**
+ * @brief Devolve o número de antenas na componente da antena em (x, y).
+ * 
+ * @param g Ponteiro para o grafo.
+ * @param x Coordenada X.
+ * @param y Coordenada Y.
+ * 
+ * @return int Tamanho da componente, ou 0 se a antena não existir.
+ */
+
+int tamanhoComponente(Grafo* g, int x, int y) {
+    if (!g) return 0;
+    Vertice* raiz = componenteDe(g, ProcurarVertice(g, x, y));
+    return raiz ? raiz->uf_tamanho : 0;
+}
+
+/**
+ * @brief Calcula as maiores coordenadas X e Y das antenas do grafo.
+ * 
+ * Usa a grelha espacial: primeiro encontra as células ocupadas mais à direita e
+ * mais abaixo e depois só percorre as antenas dessas células, em vez de toda a
+ * lista de vértices. As coordenadas negativas são ignoradas (o mínimo é 0).
+ * 
+ * @param g Ponteiro para o grafo.
+ * @param maxX Recebe a maior coordenada X.
+ * @param maxY Recebe a maior coordenada Y.
+ */
+
+static void extensaoGrafo(Grafo* g, int* maxX, int* maxY) {
+    int maxCx = 0, maxCy = 0;
+    for (size_t i = 0; i < g->celulas_cap; i++) {
+        CelulaEspacial* c = &g->celulas[i];
+        if (!c->usada || c->tamanho == 0) continue;
+        if (c->cx > maxCx) maxCx = c->cx;
+        if (c->cy > maxCy) maxCy = c->cy;
+    }
+    *maxX = 0;
+    *maxY = 0;
+    for (size_t i = 0; i < g->celulas_cap; i++) {
+        CelulaEspacial* c = &g->celulas[i];
+        if (!c->usada || (c->cx != maxCx && c->cy != maxCy)) continue;
+        for (int k = 0; k < c->tamanho; k++) {
+            if (c->membros[k]->x > *maxX) *maxX = c->membros[k]->x;
+            if (c->membros[k]->y > *maxY) *maxY = c->membros[k]->y;
+        }
+    }
+}
+
+/**
+ * @brief Gera uma representação em matriz do grafo como uma string.
+ * 
+ * Cria uma matriz 2D representada por uma string onde cada linha termina com '\n' e 
+ * a matriz contém os caracteres das frequências dos vértices nas suas posições (x, y).
+ * As posições sem vértices são preenchidas com '.'.
+ * A matriz vai de (0, 0) até às maiores coordenadas das antenas; é o mesmo que
+ * gerarMatrizJanela com essa janela.
+ * 
+ * A string resultante deve ser libertada pelo chamador para evitar memory leaks.
+ * 
+ * @param g Ponteiro para o grafo.
+ * 
+ * @return Ponteiro para uma string alocada dinamicamente contendo a matriz do grafo,
+ *         ou NULL em caso de falha na alocação.
+ */
+
+char* gerarMatrizGrafo(Grafo* g) {
+    if (!g) return NULL;
+    int maxX, maxY;
+    extensaoGrafo(g, &maxX, &maxY);
+    if (maxX == INT32_MAX || maxY == INT32_MAX) return NULL; // a largura não cabe num int
+    return gerarMatrizJanela(g, 0, 0, maxX + 1, maxY + 1, NULL);
+}
+
+/// @brief Destino de desenharAntena: a matriz de texto de uma janela
+typedef struct JanelaTexto {
+    char* buffer;              ///< Início da matriz
+    int x0, y0;                ///< Canto superior esquerdo da janela
+    size_t passo;              ///< Bytes por linha (largura + 1 do '\n')
+} JanelaTexto;
+
+/**
+ * @brief Desenha uma antena na janela de texto.
+ * 
+ * @param v Antena dentro da janela.
+ * @param contexto A JanelaTexto.
+ */
+
+static void desenharAntena(Vertice* v, void* contexto) {
+    JanelaTexto* j = contexto;
+    j->buffer[(size_t)(v->y - j->y0) * j->passo + (size_t)(v->x - j->x0)] = v->freq;
+}
+
+/**
+ * @brief Gera a matriz de texto de apenas uma janela (sub-retângulo) do mapa.
+ * 
+ * A janela vai de (x0, y0) a (x0 + largura - 1, y0 + altura - 1). O formato é o
+ * de gerarMatrizGrafo: uma linha de texto por linha do mapa, terminada em '\n',
+ * com '.' nas posições vazias. Os tamanhos são calculados em size_t, as linhas
+ * são preenchidas com memset e só as antenas da janela são visitadas (pela grelha
+ * espacial), pelo que uma janela pequena de um mapa enorme custa só o seu tamanho.
+ * 
+ * @param g Ponteiro para o grafo.
+ * @param x0 Coordenada X do canto superior esquerdo.
+ * @param y0 Coordenada Y do canto superior esquerdo.
+ * @param largura Número de colunas (maior que 0).
+ * @param altura Número de linhas (maior que 0).
+ * @param tamanho Recebe o comprimento da string, sem o '\0' (pode ser NULL).
+ * 
+ * @return char* String alocada (a libertar pelo chamador), ou NULL se os argumentos
+ *         forem inválidos, a janela sair dos limites de int ou falhar a alocação.
+ */
+
+char* gerarMatrizJanela(Grafo* g, int x0, int y0, int largura, int altura, size_t* tamanho) {
+    if (!g || largura <= 0 || altura <= 0) return NULL;
+    if ((int64_t)x0 + largura - 1 > INT32_MAX || (int64_t)y0 + altura - 1 > INT32_MAX) return NULL;
+    size_t passo = (size_t)largura + 1;
+    if ((size_t)altura > (SIZE_MAX - 1) / passo) return NULL; // não cabe em memória
+    size_t total = (size_t)altura * passo;
+
+    char* buffer = malloc(total + 1);
+    if (!buffer) return NULL;
+    for (size_t y = 0; y < (size_t)altura; y++) {
+        memset(buffer + y * passo, '.', (size_t)largura);
+        buffer[y * passo + (size_t)largura] = '\n';
+    }
+    buffer[total] = '\0';
+
+    JanelaTexto j = { buffer, x0, y0, passo };
+    percorrerGrelha(g, x0, y0, x0 + (largura - 1), y0 + (altura - 1), desenharAntena, &j);
+    if (tamanho) *tamanho = total;
+    return buffer;
+}
+
+/**
+ * @brief Marca uma antena na camada certa do mapa de ocupação.
+ * 
+ * @param v Antena dentro da janela.
+ * @param contexto O MapaOcupacao.
+ */
+
+static void marcarOcupacao(Vertice* v, void* contexto) {
+    MapaOcupacao* m = contexto;
+    int camada = v->freq == '#' ? CAMADA_NEFASTOS : CAMADA_ANTENAS;
+    size_t x = (size_t)(v->x - m->x0);
+    size_t linha = (size_t)camada * (size_t)m->altura + (size_t)(v->y - m->y0);
+    m->bits[linha * m->palavras_por_linha + x / 64] |= (uint64_t)1 << (x % 64);
+}
+
+/**
+ * @brief Gera o mapa de ocupação (1 bit por posição e por camada) de uma janela do mapa.
+ * 
+ * Há uma camada para as antenas e outra para os pontos nefastos ('#'). Cada linha
+ * de cada camada ocupa palavras_por_linha palavras de 64 bits, com a coluna x da
+ * janela no bit x % 64 da palavra x / 64. Ocupa 32 vezes menos memória do que a
+ * matriz de texto com duas camadas, e só as antenas da janela são visitadas.
+ * 
+ * @param g Ponteiro para o grafo.
+ * @param x0 Coordenada X do canto superior esquerdo.
+ * @param y0 Coordenada Y do canto superior esquerdo.
+ * @param largura Número de colunas (maior que 0).
+ * @param altura Número de linhas (maior que 0).
+ * 
+ * @return MapaOcupacao* O mapa (a libertar com libertarMapaOcupacao), ou NULL se os
+ *         argumentos forem inválidos ou falhar a alocação.
+ */
+
+MapaOcupacao* gerarMapaOcupacao(Grafo* g, int x0, int y0, int largura, int altura) {
+    if (!g || largura <= 0 || altura <= 0) return NULL;
+    if ((int64_t)x0 + largura - 1 > INT32_MAX || (int64_t)y0 + altura - 1 > INT32_MAX) return NULL;
+    size_t palavras = ((size_t)largura + 63) / 64;
+    if ((size_t)altura > SIZE_MAX / sizeof(uint64_t) / NUM_CAMADAS / palavras) return NULL;
+
+    MapaOcupacao* m = malloc(sizeof(MapaOcupacao));
+    if (!m) return NULL;
+    m->x0 = x0;
+    m->y0 = y0;
+    m->largura = largura;
+    m->altura = altura;
+    m->palavras_por_linha = palavras;
+    m->bits = calloc((size_t)NUM_CAMADAS * (size_t)altura * palavras, sizeof(uint64_t));
+    if (!m->bits) {
+        free(m);
+        return NULL;
+    }
+    percorrerGrelha(g, x0, y0, x0 + (largura - 1), y0 + (altura - 1), marcarOcupacao, m);
+    return m;
+}
+
+/**
+ * @brief Indica se uma posição do mapa está ocupada numa camada do mapa de ocupação.
+ * 
+ * @param m Mapa de ocupação.
+ * @param camada Camada a consultar.
+ * @param x Coordenada X (do mapa, não da janela).
+ * @param y Coordenada Y (do mapa, não da janela).
+ * 
+ * @return true se a posição está dentro da janela e ocupada nessa camada.
+ */
+
+bool posicaoOcupada(const MapaOcupacao* m, CamadaOcupacao camada, int x, int y) {
+    if (!m || camada < 0 || camada >= NUM_CAMADAS) return false;
+    int64_t dx = (int64_t)x - m->x0, dy = (int64_t)y - m->y0;
+    if (dx < 0 || dy < 0 || dx >= m->largura || dy >= m->altura) return false;
+    size_t linha = (size_t)camada * (size_t)m->altura + (size_t)dy;
+    return (m->bits[linha * m->palavras_por_linha + (size_t)dx / 64] >> (dx % 64)) & 1;
+}
+
+/**
+ * @brief Liberta um mapa de ocupação.
+ * 
+ * @param m Mapa a libertar (pode ser NULL).
+ * 
+ * @return MapaOcupacao* Sempre NULL, para ser atribuído ao ponteiro do chamador.
+ */
+
+MapaOcupacao* libertarMapaOcupacao(MapaOcupacao* m) {
+    if (m) {
+        free(m->bits);
+        free(m);
+    }
+    return NULL;
+}
+
+/**
+ * @brief Começa uma nova travessia: nenhum vértice fica marcado como visitado.
+ * 
+ * Em vez de percorrer os vértices para limpar uma marca, incrementa a época do
+ * grafo; um vértice só conta como visitado se a sua marca for igual à época
+ * atual, por isso a limpeza é O(1). Só quando o contador dá a volta (ao fim de
+ * 2^32 travessias) é que as marcas são postas a zero uma a uma. O vetor com a
+ * ordem de visita da travessia anterior é esvaziado.
+ * 
+ * @param g Ponteiro para o grafo.
+ * 
+ * @return true se a operação foi bem-sucedida, false se o ponteiro do grafo for NULL.
+ */
+
+bool limparVisitados(Grafo* g) {
+    if (g == NULL) return false; // falhou porque o grafo não existe
+
+    g->epoca++;
+    if (g->epoca == 0) { // deu a volta: as marcas antigas podiam coincidir com as novas épocas
+        for (Vertice* atual = g->vertices; atual != NULL; atual = atual->prox) atual->marca = 0;
+        for (int f = 0; f < 256; f++) g->grupos[f].epoca = 0; // e os cursores dos grupos
+        g->epoca = 1;
+    }
+    g->percurso_tam = 0;
+    return true; // sucesso
+}
+
+/**
+ * @brief Indica se um vértice foi visitado na travessia atual (ou na última feita).
+ * 
+ * @param g Ponteiro para o grafo.
+ * @param v Vértice a consultar.
+ * 
+ * @return true se v foi visitado, false caso contrário.
+ */
+
+bool foiVisitado(Grafo* g, Vertice* v) {
+    return g && v && g->epoca != 0 && v->marca == g->epoca;
+}
+
+/**
+ * @brief Devolve a ordem de visita da última travessia (dfs, bfs ou dfsRecursivo).
+ * 
+ * O vetor pertence ao grafo e continua válido até à próxima travessia.
+ * 
+ * @param g Ponteiro para o grafo.
+ * @param total Recebe o número de vértices visitados.
+ * 
+ * @return Vertice** Vértices pela ordem em que foram visitados, ou NULL se o grafo for NULL.
+ */
+
+Vertice** ordemVisita(Grafo* g, int* total) {
+    if (!g) return NULL;
+    if (total) *total = g->percurso_tam;
+    return g->percurso;
+}
+
+/**
+ * @brief Garante que o vetor de ordem de visita tem espaço para pelo menos n vértices.
+ * 
+ * @param g Ponteiro para o grafo.
+ * @param n Capacidade pretendida.
+ * 
+ * @return true se há espaço, false se falhar a alocação.
+ */
+
+static bool reservarPercurso(Grafo* g, int n) {
+    if (g->percurso_cap >= n) return true;
+    int cap = g->percurso_cap ? g->percurso_cap : 64;
+    while (cap < n) cap *= 2;
+    Vertice** maior = realloc(g->percurso, (size_t)cap * sizeof(Vertice*));
+    if (!maior) return false;
+    g->percurso = maior;
+    g->percurso_cap = cap;
+    return true;
+}
+
+/**
+ * @brief Marca um vértice como visitado na época atual e acrescenta-o à ordem de visita.
+ * 
+ * @param g Ponteiro para o grafo.
+ * @param v Vértice visitado.
+ * 
+ * @return true se foi registado, false se falhar a alocação do vetor de ordem.
+ */
+
+static bool registarVisita(Grafo* g, Vertice* v) {
+    if (g->percurso_tam == g->percurso_cap && !reservarPercurso(g, g->percurso_tam + 1)) return false;
+    v->marca = g->epoca;
+    g->percurso[g->percurso_tam++] = v;
+    ESTAT_CONTAR(g, passos_travessia);
+    return true;
+}
+
+/**
+ * @brief Devolve o próximo vizinho de um iterador que ainda não foi visitado na travessia atual.
+ * 
+ * Dá o mesmo vizinho que proximoVizinho seguido de saltar os já visitados, mas
+ * sem percorrer o grupo de frequência membro a membro para cada vértice: cada
+ * grupo tem um cursor, válido durante a época atual, antes do qual todos os
+ * membros já estão visitados, e os iteradores saltam diretamente para ele. Assim
+ * os membros de um grupo só são percorridos uma vez por travessia (mais os
+ * saltos sobre ligações suprimidas), em vez de O(k²).
+ * 
+ * @param g Ponteiro para o grafo.
+ * @param it Iterador preparado com iniciarVizinhos.
+ * 
+ * @return Vertice* O próximo vizinho por visitar, ou NULL quando não houver mais.
+ */
+
+static Vertice* proximoPorVisitar(Grafo* g, IteradorVizinhos* it) {
+    while (it->a) { // primeiro as arestas guardadas
+        Vertice* d = proximoVizinho(it);
+        if (d->marca != g->epoca) return d;
+    }
+    if (!it->v || !g->arestas_implicitas || !frequenciaLigavel(it->v->freq)) return NULL;
+
+    GrupoFrequencia* grupo = &g->grupos[(unsigned char)it->v->freq];
+    if (grupo->epoca != g->epoca) { // primeira vez que a travessia chega a este grupo
+        grupo->epoca = g->epoca;
+        grupo->cursor = 0;
+    }
+    while (grupo->cursor < grupo->tamanho && grupo->membros[grupo->cursor]->marca == g->epoca) grupo->cursor++;
+    if (it->i < grupo->cursor) it->i = grupo->cursor;
+    while (it->i < grupo->tamanho) {
+        Vertice* w = grupo->membros[it->i++];
+        if (w->marca == g->epoca) continue; // inclui o próprio it->v
+        if (ligacaoSuprimida(g, it->v, w)) continue; // ligação removida, consultada em O(1)
+        ESTAT_CONTAR(g, vizinhos_percorridos);
+        return w;
+    }
+    return NULL;
+}
+
+/**
+ * @brief Executa a busca em profundidade (DFS) recursiva a partir de um vértice.
+ * 
+ * Marca o vértice atual como visitado (na época atual do grafo), acrescenta-o à
+ * ordem de visita e recursa para todos os vértices adjacentes ainda não visitados.
+ * Deve ser chamada depois de limparVisitados.
+ * 
+ * @param v Ponteiro para o vértice atual da DFS.
+ * @param g Ponteiro para o grafo, onde é registada a ordem de visita.
+ * 
+ * @return true se o vértice foi visitado com sucesso, false se o vértice for NULL ou já visitado.
+ */
+
+bool dfsRecursivo(Vertice* v, Grafo* g) {
+    if (v == NULL || v->marca == g->epoca) return false;
+
+    if (!registarVisita(g, v)) return false;
+
+    IteradorVizinhos it;
+    iniciarVizinhos(&it, v);
+    for (Vertice* w = proximoPorVisitar(g, &it); w != NULL; w = proximoPorVisitar(g, &it)) {
+        dfsRecursivo(w, g);
+    }
+    return true;  // sucesso em visitar este vértice
+}
+
+/**
+ * @brief Inicia a busca em profundidade (DFS) no grafo a partir do vértice nas coordenadas (x, y).
+ * 
+ * Esta função começa uma nova travessia (limparVisitados), procura o vértice inicial
+ * com as coordenadas especificadas e visita todos os vértices alcançáveis a partir
+ * dele, registando a ordem de visita no vetor de percurso do grafo.
+ * 
+ * Em vez de recursão usa uma pilha explícita em que cada nível guarda o vértice e
+ * o iterador dos seus vizinhos por tentar, o que dá exatamente a mesma ordem de visita que
+ * dfsRecursivo sem arriscar esgotar a pilha de chamadas em componentes muito
+ * grandes. A pilha fica guardada no grafo, cresce para o dobro quando enche e é
+ * reutilizada nas chamadas seguintes.
+ * 
+ * @param g Ponteiro para o grafo onde a DFS será realizada.
+ * @param x Coordenada x do vértice inicial.
+ * @param y Coordenada y do vértice inicial.
+ * 
+ * @return true se a DFS foi iniciada e executada com sucesso, false caso contrário
+ *         (grafo inválido, vértice inicial não encontrado, falha ao alocar a pilha).
+ */
+
+bool dfs(Grafo* g, int x, int y) {
+    if (!limparVisitados(g)) return false;
+    ESTAT_INICIO(t0);
+
+    Vertice* inicio = ProcurarVertice(g, x, y);
+    if (inicio == NULL) return false;
+
+    if (!reservarPercurso(g, g->num_vertices)) return false;
+    if (g->pilha_dfs_cap == 0) {
+        g->pilha_dfs = malloc(64 * sizeof(PassoDFS));
+        if (!g->pilha_dfs) return false;
+        g->pilha_dfs_cap = 64;
+    }
+
+    int altura = 0;
+    registarVisita(g, inicio);
+    iniciarVizinhos(&g->pilha_dfs[altura].it, inicio);
+    altura++;
+
+    while (altura > 0) {
+        PassoDFS* passo = &g->pilha_dfs[altura - 1];
+        Vertice* w = proximoPorVisitar(g, &passo->it); // o iterador guarda onde ficou este nível
+        if (w == NULL) { // acabaram os vizinhos deste vértice: volta ao anterior
+            altura--;
+            continue;
+        }
+
+        if (altura == g->pilha_dfs_cap) {
+            PassoDFS* maior = realloc(g->pilha_dfs, (size_t)g->pilha_dfs_cap * 2 * sizeof(PassoDFS));
+            if (!maior) return false;
+            g->pilha_dfs = maior;
+            g->pilha_dfs_cap *= 2;
+        }
+        registarVisita(g, w);
+        iniciarVizinhos(&g->pilha_dfs[altura].it, w);
+        altura++;
+    }
+    ESTAT_FIM(g, FASE_TRAVESSIA, t0);
+    return true;
+}
+
+/**
+ * @brief Adiciona um vértice ao final da fila ligada.
+ * 
+ * Esta função cria um novo elemento de fila contendo o vértice dado (alocado
+ * no pool de fila do grafo do vértice) e o adiciona ao final da lista ligada
+ * que representa a fila.
+ * Se a fila estiver vazia (ponteiro *f é NULL), o novo elemento passa a ser o primeiro.
+ * 
+ * @param f Ponteiro para o ponteiro da fila (lista ligada) onde o vértice será adicionado.
+ * @param v Ponteiro para o vértice a ser adicionado à fila.
+ * 
+ * @return true se a operação foi bem-sucedida, false se falhou na alocação de memória.
+ */
+
+bool adicionarAFila(Fila** f, Vertice* v) {
+    Fila* novo = poolAlocar(&v->dono->pool_fila);
+    if (novo == NULL) {
+        return false;  // falha ao alocar memória
+    }
+    novo->v = v;
+    novo->prox = NULL;
+    if (*f == NULL) {
+        *f = novo;
+    } else {
+        Fila* temp = *f;
+        while (temp->prox) temp = temp->prox;
+        temp->prox = novo;
+    }
+    return true;  // sucesso
+}
+
+/**
+ * @brief Remove e retorna o primeiro vértice da fila ligada.
+ * 
+ * Esta função remove o primeiro elemento da fila (lista ligada)
+ * e retorna o ponteiro para o vértice armazenado nesse elemento.
+ * Se a fila estiver vazia, retorna NULL.
+ * 
+ * @param f Ponteiro para o ponteiro da fila (lista ligada) de onde o vértice será removido.
+ * 
+ * @return Ponteiro para o vértice removido, ou NULL se a fila estiver vazia.
+ */
+
+Vertice* removerDaFila(Fila** f) {
+    if (*f == NULL) return NULL;
+    Fila* temp = *f;
+    *f = temp->prox;
+    Vertice* v = temp->v;
+    poolLibertar(&v->dono->pool_fila, temp);
+    return v;
+}
+
+/**
+ * @brief Prepara uma fila circular com espaço para uma dada capacidade.
+ * 
+ * Se a fila já tiver um vetor com capacidade suficiente, é reutilizado; caso
+ * contrário é realocado. Em ambos os casos a fila fica vazia.
+ * 
+ * @param f Fila a preparar.
+ * @param capacidade Número máximo de elementos.
+ * 
+ * @return true se a fila está pronta, false se falhar a alocação.
+ */
+
+bool criarFilaCircular(FilaCircular* f, int capacidade) {
+    if (!f || capacidade < 0) return false;
+    if (capacidade < 1) capacidade = 1;
+    if (f->capacidade < capacidade) {
+        Vertice** itens = realloc(f->itens, (size_t)capacidade * sizeof(Vertice*));
+        if (!itens) return false;
+        f->itens = itens;
+        f->capacidade = capacidade;
+    }
+    f->inicio = 0;
+    f->tamanho = 0;
+    return true;
+}
+
+/**
+ * @brief Liberta o vetor de uma fila circular.
+ * 
+ * @param f Fila a libertar.
+ * 
+ * @return true se a fila foi libertada, false se o ponteiro for NULL.
+ */
+
+bool libertarFilaCircular(FilaCircular* f) {
+    if (!f) return false;
+    free(f->itens);
+    f->itens = NULL;
+    f->capacidade = 0;
+    f->inicio = 0;
+    f->tamanho = 0;
+    return true;
+}
+
+/**
+ * @brief Coloca um vértice no fim da fila circular.
+ * 
+ * @param f Fila.
+ * @param v Vértice a enfileirar.
+ * 
+ * @return true se foi colocado, false se a fila estiver cheia.
+ */
+
+bool enfileirar(FilaCircular* f, Vertice* v) {
+    if (f->tamanho == f->capacidade) return false;
+    int fim = f->inicio + f->tamanho;
+    if (fim >= f->capacidade) fim -= f->capacidade; // dá a volta ao vetor
+    f->itens[fim] = v;
+    f->tamanho++;
+    return true;
+}
+
+/**
+ * @brief Retira o vértice do início da fila circular.
+ * 
+ * @param f Fila.
+ * 
+ * @return Vertice* O vértice retirado, ou NULL se a fila estiver vazia.
+ */
+
+Vertice* desenfileirar(FilaCircular* f) {
+    if (f->tamanho == 0) return NULL;
+    Vertice* v = f->itens[f->inicio];
+    f->inicio++;
+    if (f->inicio == f->capacidade) f->inicio = 0;
+    f->tamanho--;
+    return v;
+}
+
+/**
+ * @brief Executa uma busca em largura (BFS) no grafo a partir do vértice com coordenadas (x, y).
+ * 
+ * A função começa uma nova travessia (limparVisitados), localiza o vértice inicial
+ * e realiza a BFS, registando a ordem de visitação no vetor de percurso do grafo.
+ * 
+ * A fila é uma fila circular com capacidade igual ao número de vértices (cada
+ * vértice entra no máximo uma vez), guardada no grafo e reutilizada entre
+ * chamadas, pelo que a procura custa O(V + E) sem alocações por vértice. No
+ * modo implícito cada grupo de frequência é percorrido uma só vez (ver
+ * proximoPorVisitar), e não uma vez por membro.
+ * 
+ * @param g Ponteiro para o grafo onde a busca será realizada.
+ * @param x Coordenada X do vértice inicial.
+ * @param y Coordenada Y do vértice inicial.
+ * 
+ * @return true se a busca foi executada com sucesso, false caso o vértice inicial não seja
+ *         encontrado ou falhe a alocação da fila.
+ */
+
+bool bfs(Grafo* g, int x, int y) {
+    limparVisitados(g);
+    ESTAT_INICIO(t0);
+    Vertice* inicio = ProcurarVertice(g, x, y);
+    if (inicio == NULL) return false;  // Não encontrou o vértice inicial
+
+    FilaCircular* fila = &g->fila_bfs;
+    if (!criarFilaCircular(fila, g->num_vertices) || !reservarPercurso(g, g->num_vertices)) return false;
+    enfileirar(fila, inicio);
+    registarVisita(g, inicio);
+
+    while (fila->tamanho > 0) {
+        Vertice* atual = desenfileirar(fila);
+        IteradorVizinhos it;
+        iniciarVizinhos(&it, atual);
+        for (Vertice* w = proximoPorVisitar(g, &it); w != NULL; w = proximoPorVisitar(g, &it)) {
+            registarVisita(g, w);
+            enfileirar(fila, w);
+        }
+    }
+    ESTAT_FIM(g, FASE_TRAVESSIA, t0);
+    return true;  // Busca executada com sucesso
+}
+
+/**
+ * @brief Mostra a ordem de visita dos vértices no grafo.
+ * 
+ * Percorre o vetor com a ordem de visita da última travessia e imprime cada
+ * vértice com as suas coordenadas, frequência e posição na ordem (a partir de 1).
+ * 
+ * @param g Ponteiro para o grafo.
+ * 
+ * @return true se pelo menos um vértice foi visitado e exibido, false caso contrário.
+ */
+
+bool mostrarcaminho(Grafo* g) {
+    printf("Ordem de visita dos vértices:\n");
+    for (int i = 0; i < g->percurso_tam; i++) {
+        Vertice* atual = g->percurso[i];
+        printf("Antena em (%d, %d), Freq: %c, Ordem: %d\n", 
+               atual->x, atual->y, atual->freq, i + 1);
+    }
+    return g->percurso_tam > 0;
+}
+
+/**
+ * @brief Lê arestas de um ficheiro binário e adiciona ao grafo.
+ * 
+ * O ficheiro binário deve conter sequências de 4 inteiros representando
+ * as coordenadas (x1, y1) e (x2, y2) de duas antenas (vértices) que
+ * serão ligadas por uma aresta.
+ * 
+ * O ficheiro é lido de uma vez e todas as arestas são adicionadas num só
+ * lote (AdicionarArestasEmLote): as extremidades que existirem no grafo são
+ * ligadas, e as arestas repetidas ou já existentes são ignoradas. Se faltar
+ * memória, nenhuma aresta do ficheiro é adicionada e é escrito um erro.
+ * 
+ * @param g Ponteiro para o grafo onde as arestas serão adicionadas.
+ * @param nomeFicheiro Nome do ficheiro binário a ser lido.
+ * 
+ * @return Ponteiro para o grafo atualizado.
+ */
+
+Grafo* LerArestasBinario(Grafo* g, const char* nomeFicheiro) {
+    ConteudoFicheiro conteudo;
+    if (!abrirConteudoFicheiro(nomeFicheiro, &conteudo)) {
+        perror("Erro ao abrir ficheiro de arestas");
+        return g;
+    }
+
+    // o ficheiro já é um vetor de quatro inteiros por aresta: vai inteiro num só lote
+    size_t numArestas = conteudo.tamanho / (4 * sizeof(int));
+    if (AdicionarArestasEmLote(g, (const int*)conteudo.dados, numArestas) == LOTE_SEM_MEMORIA) {
+        fputs("Erro ao adicionar arestas: sem memória\n", stderr);
+    }
+
+    fecharConteudoFicheiro(&conteudo);
+    return g;
+}
+
+/**
+ * @brief Guarda as arestas do grafo num ficheiro binário.
+ * 
+ * Percorre todos os vértices do grafo e escreve no ficheiro as
+ * arestas, evitando duplicação ao gravar apenas quando o id do
+ * vértice de origem é menor que o id do vértice destino.
+ * 
+ * Cada aresta é representada por quatro inteiros correspondentes às
+ * coordenadas (x, y) do vértice origem e do vértice destino.
+ * 
+ * @param g Ponteiro para o grafo cujas arestas serão guardadas.
+ * @param nomeFicheiro Nome do ficheiro binário onde as arestas serão escritas.
+ * 
+ * @return true se a operação for bem sucedida, false caso contrário.
+ */
+
+bool GuardarArestasBinario(Grafo* g, const char* nomeFicheiro) {
+    FILE* f = fopen(nomeFicheiro, "wb");
+    if (!f) {
+        return false;
+    }
+
+    Vertice* v = g->vertices;
+    while (v) {
+        IteradorVizinhos it; // inclui as ligações implícitas, se o grafo estiver nesse modo
+        iniciarVizinhos(&it, v);
+        for (Vertice* d = proximoVizinho(&it); d != NULL; d = proximoVizinho(&it)) {
+            if (v->id < d->id) {
+                fwrite(&v->x, sizeof(int), 1, f);
+                fwrite(&v->y, sizeof(int), 1, f);
+                fwrite(&d->x, sizeof(int), 1, f);
+                fwrite(&d->y, sizeof(int), 1, f);
+            }
+        }
+        v = v->prox;
+    }
+
+    fclose(f);
+    return true;
+}
+
+/**
+ * @brief Lê arestas dadas por ids de um ficheiro binário e adiciona-as ao grafo.
+ * 
+ * O ficheiro (escrito por GuardarArestasPorID) contém pares de inteiros
+ * (idOrig, idDest). As extremidades são obtidas pela tabela de ids, sem procurar
+ * coordenadas, e as arestas são inseridas num só lote com inserirArestasEmLote:
+ * as repetidas, as já existentes e as que têm um id sem vértice são ignoradas.
+ * Se faltar memória, nenhuma aresta do ficheiro é adicionada e é escrito um erro.
+ * 
+ * @param g Ponteiro para o grafo onde as arestas serão adicionadas.
+ * @param nomeFicheiro Nome do ficheiro binário a ser lido.
+ * 
+ * @return Ponteiro para o grafo atualizado.
+ */
+
+Grafo* LerArestasPorID(Grafo* g, const char* nomeFicheiro) {
+    if (!g) return g;
+    ConteudoFicheiro conteudo;
+    if (!abrirConteudoFicheiro(nomeFicheiro, &conteudo)) {
+        perror("Erro ao abrir ficheiro de arestas");
+        return g;
+    }
+
+    size_t numArestas = conteudo.tamanho / (2 * sizeof(int));
+    const int* ids = (const int*)conteudo.dados;
+    Vertice** pares = numArestas ? malloc(2 * numArestas * sizeof(Vertice*)) : NULL;
+    if (numArestas && !pares) fputs("Erro ao adicionar arestas: sem memória\n", stderr);
+    if (pares) {
+        for (size_t k = 0; k < numArestas; k++) {
+            pares[2 * k] = encontrarVerticePorID(g, ids[2 * k]);
+            pares[2 * k + 1] = encontrarVerticePorID(g, ids[2 * k + 1]);
+            if (!pares[2 * k + 1]) pares[2 * k] = NULL; // par ignorado
+        }
+        if (inserirLote(g, pares, numArestas, false) == LOTE_SEM_MEMORIA) {
+            fputs("Erro ao adicionar arestas: sem memória\n", stderr);
+        }
+        free(pares);
+    }
+
+    fecharConteudoFicheiro(&conteudo);
+    return g;
+}
+
+/**
+ * @brief Guarda as arestas do grafo num ficheiro binário, por ids.
+ * 
+ * Igual a GuardarArestasBinario, mas cada aresta ocupa só dois inteiros: o id
+ * do vértice de origem e o do destino. O ficheiro só serve para o mesmo grafo
+ * (ou para um carregado do seu instantâneo), antes de compactarIds.
+ * 
+ * @param g Ponteiro para o grafo cujas arestas serão guardadas.
+ * @param nomeFicheiro Nome do ficheiro binário onde as arestas serão escritas.
+ * 
+ * @return true se a operação for bem sucedida, false caso contrário.
+ */
+
+bool GuardarArestasPorID(Grafo* g, const char* nomeFicheiro) {
+    if (!g) return false;
+    FILE* f = fopen(nomeFicheiro, "wb");
+    if (!f) return false;
+
+    bool ok = true;
+    for (Vertice* v = g->vertices; v != NULL && ok; v = v->prox) {
+        IteradorVizinhos it; // inclui as ligações implícitas, se o grafo estiver nesse modo
+        iniciarVizinhos(&it, v);
+        for (Vertice* d = proximoVizinho(&it); d != NULL; d = proximoVizinho(&it)) {
+            if (v->id < d->id) {
+                int par[2] = { v->id, d->id };
+                if (fwrite(par, sizeof(int), 2, f) != 2) ok = false;
+            }
+        }
+    }
+
+    if (fclose(f) != 0) ok = false;
+    return ok;
+}
+
+/**
+ * @brief Congela o estado atual do grafo num instantâneo compacto em formato CSR.
+ * 
+ * Numera os vértices pela ordem da lista do grafo, conta as arestas de cada um
+ * e copia os destinos para um único vetor contíguo de índices (int32), com os
+ * deslocamentos de cada vértice guardados em `inicio`. Os atributos (x, y,
+ * frequência, id) ficam em vetores separados e é construída uma tabela de
+ * dispersão própria para procurar vértices por coordenadas.
+ * 
+ * O instantâneo não acompanha alterações posteriores ao grafo: depois de um
+ * conjunto de edições basta destruí-lo e voltar a congelar.
+ * 
+ * @param g Ponteiro para o grafo a congelar.
+ * 
+ * @return GrafoCSR* Novo instantâneo, ou NULL se o grafo for NULL, tiver mais de
+ *         INT32_MAX entradas de arestas ou falhar a alocação.
+ */
+
+GrafoCSR* CongelarGrafo(Grafo* g) {
+    if (!g) return NULL;
+
+    GrafoCSR* c = calloc(1, sizeof(GrafoCSR));
+    if (!c) return NULL;
+
+    // 1ª passagem: numera os vértices e conta as arestas
+    int32_t n = 0;
+    int64_t total = 0; // no modo implícito um grupo de k antenas dá k(k - 1) entradas
+    for (Vertice* v = g->vertices; v != NULL; v = v->prox) {
+        v->pos = n++;
+        IteradorVizinhos it; // no modo implícito as ligações do grupo são materializadas aqui
+        iniciarVizinhos(&it, v);
+        while (proximoVizinho(&it)) total++;
+    }
+    if (total > INT32_MAX) return DestruirGrafoCSR(c); // os índices de vizinhos são int32
+    int32_t m = (int32_t)total;
+
+    size_t cap = 16;
+    while (cap < (size_t)n * 2) cap *= 2;
+
+    c->num_vertices = n;
+    c->num_arestas = m;
+    c->inicio = malloc(((size_t)n + 1) * sizeof(int32_t));
+    c->vizinhos = malloc((m ? (size_t)m : 1) * sizeof(int32_t));
+    c->xs = malloc((n ? (size_t)n : 1) * sizeof(int32_t));
+    c->ys = malloc((n ? (size_t)n : 1) * sizeof(int32_t));
+    c->freqs = malloc(n ? (size_t)n : 1);
+    c->ids = malloc((n ? (size_t)n : 1) * sizeof(int32_t));
+    c->marca = calloc(n ? (size_t)n : 1, sizeof(unsigned int));
+    c->ordem = malloc((n ? (size_t)n : 1) * sizeof(int32_t));
+    c->tabela = calloc(cap, sizeof(int32_t));
+    c->tabela_cap = cap;
+    c->epoca = 0;
+    c->num_visitados = 0;
+    if (!c->inicio || !c->vizinhos || !c->xs || !c->ys || !c->freqs || !c->ids || !c->marca || !c->ordem || !c->tabela) {
+        return DestruirGrafoCSR(c);
+    }
+
+    // 2ª passagem: copia atributos e vizinhos para os vetores contíguos
+    int32_t i = 0;
+    int32_t k = 0;
+    for (Vertice* v = g->vertices; v != NULL; v = v->prox, i++) {
+        c->inicio[i] = k;
+        c->xs[i] = v->x;
+        c->ys[i] = v->y;
+        c->freqs[i] = v->freq;
+        c->ids[i] = v->id;
+        IteradorVizinhos it;
+        iniciarVizinhos(&it, v);
+        for (Vertice* d = proximoVizinho(&it); d != NULL; d = proximoVizinho(&it)) {
+            c->vizinhos[k++] = d->pos;
+        }
+
+        size_t pos = dispersarChave(chaveCoordenadas(v->x, v->y), cap - 1);
+        while (c->tabela[pos]) pos = (pos + 1) & (cap - 1);
+        c->tabela[pos] = i + 1; // 0 fica reservado para posição livre
+    }
+    c->inicio[n] = k;
+
+    return c;
+}
+
+/**
+ * @brief Liberta toda a memória de um instantâneo CSR.
+ * 
+ * @param c Ponteiro para o instantâneo (pode ser NULL).
+ * 
+ * @return NULL Para facilitar a atribuição do ponteiro a NULL após a destruição.
+ */
+
+GrafoCSR* DestruirGrafoCSR(GrafoCSR* c) {
+    if (!c) return NULL;
+    if (c->ficheiro) { // os vetores pertencem ao ficheiro: só a memória das travessias é própria
+        ConteudoFicheiro conteudo = { c->ficheiro, c->ficheiro_tamanho, c->ficheiro_mapeado };
+        fecharConteudoFicheiro(&conteudo);
+        free(c->marca);
+        free(c->ordem);
+        free(c->custo);
+        free(c->pai);
+        free(c->heap);
+        free(c->pilha);
+        free(c->cursor);
+        free(c->nivel);
+        free(c);
+        return NULL;
+    }
+    free(c->inicio);
+    free(c->vizinhos);
+    free(c->xs);
+    free(c->ys);
+    free(c->freqs);
+    free(c->ids);
+    free(c->marca);
+    free(c->ordem);
+    free(c->tabela);
+    free(c->custo);
+    free(c->pai);
+    free(c->heap);
+    free(c->pilha);
+    free(c->cursor);
+    free(c->nivel);
+    free(c);
+    return NULL;
+}
+
+/**
+ * @brief Procura no instantâneo CSR o índice do vértice com coordenadas (x, y).
+ * 
+ * @param c Ponteiro para o instantâneo.
+ * @param x Coordenada X.
+ * @param y Coordenada Y.
+ * 
+ * @return int32_t Índice do vértice, ou -1 se não existir.
+ */
+
+int32_t ProcurarVerticeCSR(GrafoCSR* c, int x, int y) {
+    if (!c) return -1;
+    size_t mascara = c->tabela_cap - 1;
+    size_t pos = dispersarChave(chaveCoordenadas(x, y), mascara);
+    for (size_t sondagens = 0; sondagens < c->tabela_cap && c->tabela[pos]; sondagens++) { // nunca mais do que a tabela inteira
+        int32_t i = c->tabela[pos] - 1;
+        if (c->xs[i] == x && c->ys[i] == y) return i;
+        pos = (pos + 1) & mascara;
+    }
+    return -1;
+}
+
+/**
+ * @brief Dá acesso aos vizinhos de um vértice de um grafo CSR, sem copiar.
+ * 
+ * @param c Ponteiro para o instantâneo.
+ * @param i Índice do vértice (por exemplo, devolvido por ProcurarVerticeCSR).
+ * @param vizinhos Recebe o ponteiro para o primeiro índice de vizinho (pode ser NULL).
+ * 
+ * @return int32_t Número de vizinhos, ou -1 se o índice for inválido.
+ */
+
+int32_t vizinhosCSR(GrafoCSR* c, int32_t i, const int32_t** vizinhos) {
+    if (!c || i < 0 || i >= c->num_vertices) return -1;
+    if (vizinhos) *vizinhos = c->vizinhos + c->inicio[i];
+    return c->inicio[i + 1] - c->inicio[i];
+}
+
+/**
+ * @brief Lista as antenas de um instantâneo CSR e as suas ligações.
+ * 
+ * Produz exatamente o mesmo texto que listarAntenas sobre o grafo que foi congelado.
+ * 
+ * @param c Ponteiro para o instantâneo.
+ * @param contador Ponteiro onde é guardado o número de antenas listadas.
+ * 
+ * @return true se a listagem foi feita, false se algum ponteiro for NULL ou falhar a escrita.
+ */
+
+bool listarAntenasCSR(GrafoCSR* c, int* contador) {
+    if (!c || !contador) return false;
+
+    EscritorSaida e;
+    if (!escritorFicheiro(&e, stdout)) return false;
+    bool ok = listarAntenasCSREscritor(c, &e, contador);
+    return fecharEscritor(&e) && ok;
+}
+
+/**
+ * @brief Lista as antenas do instantâneo e os seus vizinhos para um escritor.
+ * 
+ * Escreve o mesmo texto que listarAntenasCSR. O escritor não é fechado.
+ * 
+ * @param c Ponteiro para o instantâneo.
+ * @param e Escritor de destino.
+ * @param contador Recebe o número de antenas listadas.
+ * 
+ * @return true se todo o texto foi escrito, false se os argumentos forem inválidos ou falhar a escrita.
+ */
+
+bool listarAntenasCSREscritor(GrafoCSR* c, EscritorSaida* e, int* contador) {
+    if (!c || !e || !e->buffer || !contador) return false;
+
+    *contador = 0;
+    for (int32_t i = 0; i < c->num_vertices; i++) {
+        if (!escreverCabecaAntena(e, c->xs[i], c->ys[i], c->freqs[i])) return false;
+        for (int32_t k = c->inicio[i]; k < c->inicio[i + 1]; k++) {
+            int32_t d = c->vizinhos[k];
+            if (!escritorReservar(e, ESCRITOR_MAX_ANTENA)) return false;
+            e->usados = (size_t)(escreverVizinho(e->buffer + e->usados, c->freqs[d], c->xs[d], c->ys[d]) - e->buffer);
+        }
+        if (!escritorReservar(e, 1)) return false;
+        e->buffer[e->usados++] = '\n';
+        (*contador)++;
+    }
+    return !e->erro;
+}
+
+/**
+ * @brief Começa uma nova travessia sobre um instantâneo CSR (limpeza O(1) por época).
+ * 
+ * @param c Ponteiro para o instantâneo.
+ */
+
+static void novaEpocaCSR(GrafoCSR* c) {
+    c->epoca++;
+    if (c->epoca == 0) { // deu a volta ao contador
+        memset(c->marca, 0, (size_t)c->num_vertices * sizeof(unsigned int));
+        c->epoca = 1;
+    }
+    c->num_visitados = 0;
+}
+
+/**
+ * @brief Busca em profundidade (DFS) sobre um instantâneo CSR.
+ * 
+ * Usa uma pilha explícita com o cursor de vizinhos de cada vértice, o que dá a
+ * mesma ordem de visita que a versão sobre listas (dfs) sem depender da pilha
+ * de chamadas. A ordem fica guardada em c->ordem. A pilha é do instantâneo e é
+ * reaproveitada entre consultas.
+ * 
+ * @param c Ponteiro para o instantâneo.
+ * @param x Coordenada X do vértice inicial.
+ * @param y Coordenada Y do vértice inicial.
+ * 
+ * @return true se a DFS foi executada, false se o vértice inicial não existir ou falhar a alocação.
+ */
+
+bool dfsCSR(GrafoCSR* c, int x, int y) {
+    if (!c) return false;
+    novaEpocaCSR(c);
+
+    int32_t inicio = ProcurarVerticeCSR(c, x, y);
+    if (inicio < 0) return false;
+
+    if (!c->pilha) c->pilha = malloc((size_t)c->num_vertices * sizeof(int32_t)); // reservados na primeira consulta
+    if (!c->cursor) c->cursor = malloc((size_t)c->num_vertices * sizeof(int32_t));
+    if (!c->pilha || !c->cursor) return false;
+    int32_t* pilha = c->pilha;   // vértice de cada nível
+    int32_t* cursor = c->cursor; // próximo vizinho a tentar
+
+    int32_t altura = 0;
+    c->marca[inicio] = c->epoca;
+    c->ordem[c->num_visitados++] = inicio;
+    pilha[altura] = inicio;
+    cursor[altura] = c->inicio[inicio];
+    altura++;
+
+    while (altura > 0) {
+        int32_t v = pilha[altura - 1];
+        int32_t k = cursor[altura - 1];
+        while (k < c->inicio[v + 1] && c->marca[c->vizinhos[k]] == c->epoca) k++; // salta vizinhos já visitados
+        if (k == c->inicio[v + 1]) { // acabaram os vizinhos deste vértice
+            altura--;
+            continue;
+        }
+        cursor[altura - 1] = k + 1;
+        int32_t w = c->vizinhos[k];
+        c->marca[w] = c->epoca;
+        c->ordem[c->num_visitados++] = w;
+        pilha[altura] = w;
+        cursor[altura] = c->inicio[w];
+        altura++;
+    }
+    return true;
+}
+
+/**
+ * @brief Busca em largura (BFS) sobre um instantâneo CSR.
+ * 
+ * A fila é um vetor de índices com o tamanho do número de vértices, já que cada
+ * vértice entra no máximo uma vez; é do instantâneo (a mesma que a pilha de
+ * dfsCSR) e é reaproveitada entre consultas. A ordem de visita fica guardada em c->ordem.
+ * 
+ * @param c Ponteiro para o instantâneo.
+ * @param x Coordenada X do vértice inicial.
+ * @param y Coordenada Y do vértice inicial.
+ * 
+ * @return true se a BFS foi executada, false se o vértice inicial não existir ou falhar a alocação.
+ */
+
+bool bfsCSR(GrafoCSR* c, int x, int y) {
+    if (!c) return false;
+    novaEpocaCSR(c);
+
+    int32_t inicio = ProcurarVerticeCSR(c, x, y);
+    if (inicio < 0) return false;
+
+    if (!c->pilha) c->pilha = malloc((size_t)c->num_vertices * sizeof(int32_t)); // partilhada com dfsCSR
+    if (!c->pilha) return false;
+    int32_t* fila = c->pilha;
+
+    int32_t frente = 0, fim = 0;
+    fila[fim++] = inicio;
+    c->marca[inicio] = c->epoca;
+    c->ordem[c->num_visitados++] = inicio;
+
+    while (frente < fim) {
+        int32_t v = fila[frente++];
+        for (int32_t k = c->inicio[v]; k < c->inicio[v + 1]; k++) {
+            int32_t w = c->vizinhos[k];
+            if (c->marca[w] != c->epoca) {
+                c->marca[w] = c->epoca;
+                c->ordem[c->num_visitados++] = w;
+                fila[fim++] = w;
+            }
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Mostra a ordem de visita do último percurso feito sobre um instantâneo CSR.
+ * 
+ * @param c Ponteiro para o instantâneo.
+ * 
+ * @return true se pelo menos um vértice foi visitado e exibido, false caso contrário.
+ */
+
+bool mostrarcaminhoCSR(GrafoCSR* c) {
+    if (!c) return false;
+    printf("Ordem de visita dos vértices:\n");
+    for (int32_t k = 0; k < c->num_visitados; k++) {
+        int32_t i = c->ordem[k];
+        printf("Antena em (%d, %d), Freq: %c, Ordem: %d\n",
+               c->xs[i], c->ys[i], c->freqs[i], k + 1);
+    }
+    return c->num_visitados > 0;
+}
+
+#define INSTANTANEO_BUFFER (1 << 20) ///< Buffer do FILE* usado para escrever um instantâneo
+
+static uint32_t tabelaCRC[256];
+static pthread_once_t tabelaCRCPronta = PTHREAD_ONCE_INIT;
+
+/**
+ * @brief Preenche a tabela do CRC-32 (polinómio 0xEDB88320, o mesmo do zip e do PNG).
+ */
+
+static void iniciarTabelaCRC(void) {
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t c = i;
+        for (int k = 0; k < 8; k++) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+        tabelaCRC[i] = c;
+    }
+}
+
+/**
+ * @brief Acrescenta um bloco de bytes a um CRC-32 em curso.
+ * 
+ * @param crc Valor devolvido pela chamada anterior (0 no início).
+ * @param dados Bytes a acrescentar.
+ * @param n Número de bytes.
+ * 
+ * @return uint32_t O CRC-32 dos bytes vistos até agora.
+ */
+
+static uint32_t atualizarCRC(uint32_t crc, const void* dados, size_t n) {
+    pthread_once(&tabelaCRCPronta, iniciarTabelaCRC);
+    const unsigned char* p = dados;
+    crc = ~crc;
+    for (size_t i = 0; i < n; i++) crc = tabelaCRC[(crc ^ p[i]) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+/**
+ * @brief Calcula o tamanho útil (sem alinhamento) de cada secção de um instantâneo.
+ * 
+ * @param cab Cabeçalho com num_vertices, num_arestas e tabela_cap preenchidos.
+ * @param bytes Vetor de INSTANTANEO_SECOES posições a preencher.
+ */
+
+static void tamanhosInstantaneo(const CabecalhoInstantaneo* cab, uint64_t* bytes) {
+    uint64_t n = (uint64_t)cab->num_vertices;
+    bytes[0] = n * sizeof(int32_t);                            // xs
+    bytes[1] = n * sizeof(int32_t);                            // ys
+    bytes[2] = n * sizeof(int32_t);                            // ids
+    bytes[3] = n;                                              // freqs
+    bytes[4] = (n + 1) * sizeof(int32_t);                      // inicio
+    bytes[5] = (uint64_t)cab->num_arestas * sizeof(int32_t);   // vizinhos
+    bytes[6] = (uint64_t)cab->tabela_cap * sizeof(int32_t);    // tabela
+}
+
+/**
+ * @brief Calcula a posição de cada secção de um instantâneo a partir das contagens do cabeçalho.
+ * 
+ * Cada secção começa num múltiplo de 8 bytes, para que os vetores possam ser
+ * usados diretamente a partir do ficheiro mapeado em memória.
+ * 
+ * @param cab Cabeçalho com num_vertices, num_arestas e tabela_cap preenchidos;
+ *            secoes e tamanho são preenchidos aqui.
+ */
+
+static void disporInstantaneo(CabecalhoInstantaneo* cab) {
+    uint64_t bytes[INSTANTANEO_SECOES];
+    tamanhosInstantaneo(cab, bytes);
+    uint64_t pos = (sizeof(CabecalhoInstantaneo) + 7) & ~(uint64_t)7;
+    for (int s = 0; s < INSTANTANEO_SECOES; s++) {
+        cab->secoes[s] = pos;
+        pos = (pos + bytes[s] + 7) & ~(uint64_t)7;
+    }
+    cab->tamanho = pos;
+}
+
+/**
+ * @brief Escreve um instantâneo CSR num ficheiro, numa só passagem.
+ * 
+ * O cabeçalho é escrito primeiro com o CRC a zero; as secções seguem pelo
+ * buffer do FILE* enquanto o CRC é calculado, e no fim o cabeçalho é
+ * reescrito com o valor final.
+ * 
+ * @param c Instantâneo a escrever.
+ * @param cab Cabeçalho já disposto (disporInstantaneo) e com os campos do grafo preenchidos.
+ * @param f Ficheiro aberto em modo binário.
+ * 
+ * @return true se tudo foi escrito, false em caso de erro de escrita.
+ */
+
+static bool escreverInstantaneo(GrafoCSR* c, CabecalhoInstantaneo* cab, FILE* f) {
+    const void* dados[INSTANTANEO_SECOES] = { c->xs, c->ys, c->ids, c->freqs, c->inicio, c->vizinhos, c->tabela };
+    static const char zeros[8] = { 0 };
+    uint64_t bytes[INSTANTANEO_SECOES];
+    tamanhosInstantaneo(cab, bytes);
+
+    if (fwrite(cab, sizeof(*cab), 1, f) != 1) return false;
+    uint64_t pos = sizeof(*cab);
+    uint32_t crc = 0;
+    for (int s = 0; s <= INSTANTANEO_SECOES; s++) {
+        uint64_t proxima = s < INSTANTANEO_SECOES ? cab->secoes[s] : cab->tamanho;
+        size_t falta = (size_t)(proxima - pos); // alinhamento até à secção seguinte
+        if (falta && fwrite(zeros, 1, falta, f) != falta) return false;
+        crc = atualizarCRC(crc, zeros, falta);
+        if (s == INSTANTANEO_SECOES) break;
+
+        size_t n = (size_t)bytes[s];
+        if (n && fwrite(dados[s], 1, n, f) != n) return false;
+        crc = atualizarCRC(crc, dados[s], n);
+        pos = proxima + n;
+    }
+
+    cab->crc = crc;
+    if (fseek(f, 0, SEEK_SET) != 0) return false;
+    return fwrite(cab, sizeof(*cab), 1, f) == 1;
+}
+
+/**
+ * @brief Guarda o grafo (vértices e arestas) num instantâneo binário versionado.
+ * 
+ * O grafo é congelado em CSR e cada secção é escrita de seguida, pelo buffer
+ * do ficheiro, com um cabeçalho que tem a versão, as contagens e o CRC-32 dos
+ * dados. As arestas ficam guardadas por índice de vértice, com cada direção em
+ * separado, e pela mesma ordem das listas do grafo. No modo implícito as
+ * ligações do grupo de frequência são escritas como arestas normais.
+ * 
+ * @param g Ponteiro para o grafo.
+ * @param nomeFicheiro Nome do ficheiro a criar.
+ * 
+ * @return true se o ficheiro foi escrito por completo, false caso contrário.
+ */
+
+bool GuardarInstantaneo(Grafo* g, const char* nomeFicheiro) {
+    if (!g || !nomeFicheiro) return false;
+    ESTAT_INICIO(t0);
+
+    GrafoCSR* c = CongelarGrafo(g);
+    if (!c) return false;
+
+    CabecalhoInstantaneo cab;
+    memset(&cab, 0, sizeof(cab));
+    memcpy(cab.magia, INSTANTANEO_MAGIA, sizeof(cab.magia));
+    cab.versao = INSTANTANEO_VERSAO;
+    cab.num_vertices = c->num_vertices;
+    cab.num_arestas = c->num_arestas;
+    cab.largura = g->largura;
+    cab.altura = g->altura;
+    cab.proximo_id = g->proximo_id;
+    cab.tabela_cap = (uint32_t)c->tabela_cap;
+    disporInstantaneo(&cab);
+
+    FILE* f = fopen(nomeFicheiro, "wb");
+    if (!f) {
+        DestruirGrafoCSR(c);
+        return false;
+    }
+    setvbuf(f, NULL, _IOFBF, INSTANTANEO_BUFFER);
+    bool ok = escreverInstantaneo(c, &cab, f);
+    if (fclose(f) != 0) ok = false;
+    DestruirGrafoCSR(c);
+    if (!ok) remove(nomeFicheiro); // não deixa um instantâneo meio escrito
+    else ESTAT_FIM(g, FASE_INSTANTANEO, t0);
+    return ok;
+}
+
+/**
+ * @brief Verifica só o cabeçalho de um instantâneo: assinatura, versão e posição das secções.
+ * 
+ * É uma verificação em tempo constante, que não lê os dados das secções.
+ * 
+ * @param dados Conteúdo do ficheiro.
+ * @param tamanho Tamanho do conteúdo em bytes.
+ * @param cab Recebe uma cópia do cabeçalho.
+ * 
+ * @return true se o cabeçalho é coerente com o tamanho do ficheiro.
+ */
+
+static bool validarCabecalhoInstantaneo(const char* dados, size_t tamanho, CabecalhoInstantaneo* cab) {
+    if (tamanho < sizeof(*cab)) return false;
+    memcpy(cab, dados, sizeof(*cab));
+    if (memcmp(cab->magia, INSTANTANEO_MAGIA, sizeof(cab->magia)) != 0) return false;
+    if (cab->versao != INSTANTANEO_VERSAO) return false;
+    if (cab->num_vertices < 0 || cab->num_arestas < 0) return false;
+    if (cab->tabela_cap == 0 || (cab->tabela_cap & (cab->tabela_cap - 1)) != 0) return false;
+    if ((uint64_t)cab->tabela_cap < 2 * (uint64_t)cab->num_vertices) return false; // a procura precisa de posições livres
+
+    CabecalhoInstantaneo esperado = *cab; // as secções têm de estar onde o formato as põe
+    disporInstantaneo(&esperado);
+    if (memcmp(esperado.secoes, cab->secoes, sizeof(cab->secoes)) != 0) return false;
+    return esperado.tamanho == cab->tamanho && cab->tamanho == tamanho;
+}
+
+/**
+ * @brief Verifica os índices de um instantâneo com o cabeçalho já validado.
+ * 
+ * Confirma, em O(V + E + tabela_cap), que os deslocamentos são crescentes e vão
+ * de 0 a num_arestas, que cada vizinho é um vértice e que cada posição da tabela
+ * de coordenadas está vazia ou aponta para um vértice, com no máximo V posições
+ * ocupadas (e portanto, como tabela_cap >= 2V, alguma livre). Sem isto, um
+ * ficheiro corrompido faria as travessias e as procuras lerem fora das secções,
+ * ou uma procura falhada sondar a tabela para sempre. O CRC não chega, porque
+ * quem escreve o ficheiro também o pode calcular.
+ * 
+ * @param dados Conteúdo do ficheiro.
+ * @param cab Cabeçalho validado por validarCabecalhoInstantaneo.
+ * 
+ * @return true se todos os índices estão dentro dos limites.
+ */
+
+static bool validarIndicesInstantaneo(const char* dados, const CabecalhoInstantaneo* cab) {
+    const int32_t* inicio = (const int32_t*)(dados + cab->secoes[4]);
+    const int32_t* vizinhos = (const int32_t*)(dados + cab->secoes[5]);
+    const int32_t* tabela = (const int32_t*)(dados + cab->secoes[6]);
+    int32_t n = cab->num_vertices;
+    if (inicio[0] != 0 || inicio[n] != cab->num_arestas) return false;
+    for (int32_t i = 0; i < n; i++) {
+        if (inicio[i + 1] < inicio[i]) return false;
+    }
+    for (int32_t k = 0; k < cab->num_arestas; k++) {
+        if (vizinhos[k] < 0 || vizinhos[k] >= n) return false;
+    }
+    int64_t ocupadas = 0;
+    for (uint32_t k = 0; k < cab->tabela_cap; k++) {
+        if (tabela[k] < 0 || tabela[k] > n) return false;
+        if (tabela[k]) ocupadas++;
+    }
+    return ocupadas <= n;
+}
+
+/**
+ * @brief Verifica um instantâneo em memória: assinatura, versão, tamanhos, CRC e índices.
+ * 
+ * @param dados Conteúdo do ficheiro.
+ * @param tamanho Tamanho do conteúdo em bytes.
+ * @param cab Recebe uma cópia do cabeçalho.
+ * 
+ * @return true se o instantâneo é válido e pode ser usado sem mais verificações.
+ */
+
+static bool validarInstantaneo(const char* dados, size_t tamanho, CabecalhoInstantaneo* cab) {
+    if (!validarCabecalhoInstantaneo(dados, tamanho, cab)) return false;
+    if (atualizarCRC(0, dados + sizeof(*cab), tamanho - sizeof(*cab)) != cab->crc) return false;
+    return validarIndicesInstantaneo(dados, cab);
+}
+
+/**
+ * @brief Carrega um grafo de um instantâneo binário escrito por GuardarInstantaneo.
+ * 
+ * O ficheiro é validado por completo (versão, tamanhos, CRC, índices) antes de
+ * se criar o grafo. Toda a memória dos vértices, das arestas e do índice de
+ * coordenadas é reservada de uma vez. Coordenadas repetidas são detetadas na
+ * própria inserção no índice, sem procuras à parte, e as arestas são ligadas
+ * diretamente por índice, sem verificação de duplicados. Os ids,
+ * a ordem dos vértices e a ordem das arestas ficam iguais às do grafo guardado.
+ * 
+ * Tal como LerFicheiro, devolve um grafo novo em caso de sucesso e o grafo
+ * recebido, sem alterações, em caso de erro.
+ * 
+ * @param g Ponteiro para o grafo atual.
+ * @param nomeFicheiro Nome do ficheiro do instantâneo.
+ * @param sucesso Ponteiro para uma variável que indica se a operação teve sucesso.
+ * 
+ * @return Grafo* O grafo carregado, ou g se o ficheiro não existir ou for inválido.
+ */
+
+Grafo* CarregarInstantaneo(Grafo* g, const char* nomeFicheiro, bool* sucesso) {
+    *sucesso = false;
+    ESTAT_INICIO(t0);
+    ConteudoFicheiro conteudo;
+    if (!abrirConteudoFicheiro(nomeFicheiro, &conteudo)) return g;
+
+    CabecalhoInstantaneo cab;
+    if (!validarInstantaneo(conteudo.dados, conteudo.tamanho, &cab)) {
+        fecharConteudoFicheiro(&conteudo);
+        return g;
+    }
+    const int32_t* xs = (const int32_t*)(conteudo.dados + cab.secoes[0]);
+    const int32_t* ys = (const int32_t*)(conteudo.dados + cab.secoes[1]);
+    const int32_t* ids = (const int32_t*)(conteudo.dados + cab.secoes[2]);
+    const char* freqs = conteudo.dados + cab.secoes[3];
+    const int32_t* inicio = (const int32_t*)(conteudo.dados + cab.secoes[4]);
+    const int32_t* vizinhos = (const int32_t*)(conteudo.dados + cab.secoes[5]);
+    int32_t n = cab.num_vertices;
+
+    Grafo* novo = CriarGrafo();
+    Vertice** porIndice = malloc((n ? (size_t)n : 1) * sizeof(Vertice*));
+    bool erro = !novo || !porIndice ||
+                !indiceReservar(novo, (size_t)n) ||
+                !poolReservar(&novo->pool_vertices, (size_t)n) ||
+                !poolReservar(&novo->pool_arestas, 2 * (size_t)cab.num_arestas); // arestas e entradas
+
+    // criados do último para o primeiro, para a lista ficar pela ordem do ficheiro
+    for (int32_t i = n - 1; i >= 0 && !erro; i--) {
+        Vertice* v = criarVertice(novo, xs[i], ys[i], freqs[i]);
+        if (!v) { // coordenadas repetidas (instantâneo incoerente) ou falta de memória
+            erro = true;
+            break;
+        }
+        v->id = ids[i];
+        porIndice[i] = v;
+    }
+    if (!erro && !idsReconstruir(novo, cab.proximo_id)) erro = true; // ids repetidos ou fora de [0, proximo_id)
+    for (int32_t i = 0; i < n && !erro; i++) {
+        for (int32_t k = inicio[i + 1] - 1; k >= inicio[i]; k--) { // do fim para o início, pela mesma razão
+            if (!acrescentarAresta(novo, porIndice[i], porIndice[vizinhos[k]])) {
+                erro = true;
+                break;
+            }
+        }
+    }
+
+    free(porIndice);
+    fecharConteudoFicheiro(&conteudo);
+    if (erro) {
+        if (novo) {
+            bool destruido;
+            DestruirGrafo(novo, &destruido);
+        }
+        return g;
+    }
+    novo->largura = cab.largura;
+    novo->altura = cab.altura;
+    novo->componentes_validas = false; // recalculadas na primeira consulta
+    *sucesso = true;
+    ESTAT_FIM(novo, FASE_INSTANTANEO, t0);
+    return novo;
+}
+
+/**
+ * @brief Abre um instantâneo binário como grafo CSR só de leitura, sem o copiar.
+ * 
+ * O ficheiro escrito por GuardarInstantaneo é mapeado em memória e os vetores do
+ * GrafoCSR (atributos, deslocamentos, vizinhos e tabela de coordenadas) apontam
+ * diretamente para as suas secções, que estão por índice e alinhadas. Só as
+ * marcas e a ordem das travessias são alocadas. Assim, vários processos que
+ * abram o mesmo ficheiro partilham as mesmas páginas em cache e nada é copiado
+ * nem convertido em nós. ProcurarVerticeCSR, vizinhosCSR, bfsCSR, dfsCSR e
+ * as restantes funções CSR funcionam sobre o resultado como sobre um grafo
+ * congelado; os vetores não podem ser alterados.
+ * 
+ * O custo de abrir depende da verificação pedida. Com VERIFICAR_INDICES os
+ * índices (deslocamentos, vizinhos e tabela de coordenadas) são percorridos, em
+ * O(V + E + tabela_cap), ou seja, linear no tamanho das secções de índices,
+ * para que um ficheiro corrompido não leve as funções CSR a ler fora das secções.
+ * VERIFICAR_TUDO também verifica o CRC, o que obriga a ler o ficheiro inteiro
+ * (incluindo os atributos). Só com VERIFICAR_CABECALHO a abertura é O(1) e não
+ * toca nas secções: é para ficheiros de confiança (por exemplo, escritos pelo
+ * próprio serviço), porque índices corrompidos dão leituras fora do ficheiro.
+ * Em Windows o ficheiro é lido para um buffer em vez de mapeado.
+ * 
+ * @param nomeFicheiro Nome do ficheiro do instantâneo.
+ * @param verificacao Verificações a fazer antes de o usar.
+ * 
+ * @return GrafoCSR* O grafo só de leitura, ou NULL se o ficheiro não existir, for inválido ou falhar a alocação.
+ */
+
+GrafoCSR* AbrirInstantaneoCSR(const char* nomeFicheiro, VerificacaoInstantaneo verificacao) {
+    ConteudoFicheiro conteudo;
+    if (!abrirConteudoFicheiro(nomeFicheiro, &conteudo)) return NULL;
+
+    CabecalhoInstantaneo cab;
+    bool valido;
+    if (verificacao == VERIFICAR_TUDO) valido = validarInstantaneo(conteudo.dados, conteudo.tamanho, &cab);
+    else valido = validarCabecalhoInstantaneo(conteudo.dados, conteudo.tamanho, &cab) &&
+                  (verificacao == VERIFICAR_CABECALHO || validarIndicesInstantaneo(conteudo.dados, &cab));
+    GrafoCSR* c = valido ? calloc(1, sizeof(GrafoCSR)) : NULL;
+    if (!c) {
+        fecharConteudoFicheiro(&conteudo);
+        return NULL;
+    }
+#ifndef _WIN32
+    if (conteudo.mapeado) madvise((void*)conteudo.dados, conteudo.tamanho, MADV_RANDOM); // procuras e travessias saltam pelo ficheiro
+#endif
+
+    char* base = (char*)conteudo.dados; // só de leitura: os vetores nunca são escritos pelas funções CSR
+    size_t n = (size_t)cab.num_vertices;
+    c->ficheiro = conteudo.dados;
+    c->ficheiro_tamanho = conteudo.tamanho;
+    c->ficheiro_mapeado = conteudo.mapeado;
+    c->num_vertices = cab.num_vertices;
+    c->num_arestas = cab.num_arestas;
+    c->xs = (int32_t*)(base + cab.secoes[0]);
+    c->ys = (int32_t*)(base + cab.secoes[1]);
+    c->ids = (int32_t*)(base + cab.secoes[2]);
+    c->freqs = base + cab.secoes[3];
+    c->inicio = (int32_t*)(base + cab.secoes[4]);
+    c->vizinhos = (int32_t*)(base + cab.secoes[5]);
+    c->tabela = (int32_t*)(base + cab.secoes[6]);
+    c->tabela_cap = cab.tabela_cap;
+    c->marca = calloc(n ? n : 1, sizeof(unsigned int));
+    c->ordem = malloc((n ? n : 1) * sizeof(int32_t));
+    if (!c->marca || !c->ordem) return DestruirGrafoCSR(c);
+    return c;
+}
+
+#define BFS_BLOCO 64               ///< Vértices da fronteira que cada fio reserva de uma vez
+#define BFS_FRONTEIRA_MINIMA 1024  ///< Abaixo disto o nível é expandido só pelo fio que chamou
+
+/// @brief Barreira simples entre fios (mutex + variável de condição)
+typedef struct BarreiraFios {
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    int total;                 ///< Número de fios que têm de chegar
+    int chegados;              ///< Fios que já chegaram nesta ronda
+    unsigned int ronda;        ///< Muda sempre que a barreira abre
+} BarreiraFios;
+
+/// @brief Estado partilhado da BFS paralela por níveis
+typedef struct TrabalhoBFS {
+    GrafoCSR* c;               ///< Grafo percorrido
+    atomic_int* nivel;         ///< Nível de cada vértice (-1 = ainda não visitado)
+    const int32_t* fronteira;  ///< Vértices do nível atual (dentro de c->ordem)
+    int32_t tam_fronteira;     ///< Número de vértices na fronteira
+    int nivel_atual;           ///< Nível dos vértices da fronteira
+    atomic_int proximo;        ///< Próxima posição da fronteira ainda não reservada
+    BarreiraFios barreira;     ///< Sincroniza o início e o fim de cada nível
+    bool terminou;             ///< Avisa os fios de que não há mais níveis
+} TrabalhoBFS;
+
+/// @brief Estado de cada fio da BFS paralela: vértices que descobriu no nível atual
+typedef struct FioBFS {
+    TrabalhoBFS* t;            ///< Trabalho partilhado
+    int32_t* novos;            ///< Vértices reclamados por este fio
+    size_t tam, cap;           ///< Ocupação e capacidade de novos
+    bool erro;                 ///< Falha de alocação
+} FioBFS;
+
+/**
+ * @brief Prepara uma barreira para um dado número de fios.
+ * 
+ * @param b Barreira.
+ * @param total Número de fios que a usam.
+ * 
+ * @return true se ficou pronta.
+ */
+
+static bool barreiraIniciar(BarreiraFios* b, int total) {
+    b->total = total;
+    b->chegados = 0;
+    b->ronda = 0;
+    if (pthread_mutex_init(&b->mutex, NULL) != 0) return false;
+    if (pthread_cond_init(&b->cond, NULL) != 0) {
+        pthread_mutex_destroy(&b->mutex);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Espera até todos os fios chegarem à barreira.
+ * 
+ * @param b Barreira.
+ */
+
+static void barreiraEsperar(BarreiraFios* b) {
+    pthread_mutex_lock(&b->mutex);
+    unsigned int ronda = b->ronda;
+    if (++b->chegados == b->total) { // último a chegar: abre para todos
+        b->chegados = 0;
+        b->ronda++;
+        pthread_cond_broadcast(&b->cond);
+    } else {
+        while (ronda == b->ronda) pthread_cond_wait(&b->cond, &b->mutex);
+    }
+    pthread_mutex_unlock(&b->mutex);
+}
+
+/**
+ * @brief Liberta os recursos de uma barreira.
+ * 
+ * @param b Barreira.
+ */
+
+static void barreiraDestruir(BarreiraFios* b) {
+    pthread_cond_destroy(&b->cond);
+    pthread_mutex_destroy(&b->mutex);
+}
+
+/**
+ * @brief Expande a parte da fronteira que couber a este fio.
+ * 
+ * Os vértices da fronteira são reservados em blocos de BFS_BLOCO. Cada vizinho
+ * ainda não visitado é reclamado com uma troca atómica do seu nível, por isso
+ * só um fio o acrescenta aos seus novos, seja qual for a ordem de execução.
+ * 
+ * @param f Fio que trabalha.
+ */
+
+static void expandirNivelBFS(FioBFS* f) {
+    TrabalhoBFS* t = f->t;
+    GrafoCSR* c = t->c;
+    int seguinte = t->nivel_atual + 1;
+    for (;;) {
+        int32_t primeiro = atomic_fetch_add_explicit(&t->proximo, BFS_BLOCO, memory_order_relaxed);
+        if (primeiro >= t->tam_fronteira) break;
+        int32_t ultimo = primeiro + BFS_BLOCO < t->tam_fronteira ? primeiro + BFS_BLOCO : t->tam_fronteira;
+        for (int32_t i = primeiro; i < ultimo; i++) {
+            int32_t v = t->fronteira[i];
+            for (int32_t k = c->inicio[v]; k < c->inicio[v + 1]; k++) {
+                int32_t w = c->vizinhos[k];
+                int esperado = -1;
+                if (atomic_load_explicit(&t->nivel[w], memory_order_relaxed) != -1) continue; // já visitado
+                if (!atomic_compare_exchange_strong_explicit(&t->nivel[w], &esperado, seguinte,
+                                                             memory_order_relaxed, memory_order_relaxed)) continue;
+                if (f->tam == f->cap) {
+                    size_t cap = f->cap ? f->cap * 2 : 256;
+                    int32_t* maior = realloc(f->novos, cap * sizeof(int32_t));
+                    if (!maior) {
+                        f->erro = true;
+                        continue; // fica marcado mas não entra na ordem; a BFS falha no fim
+                    }
+                    f->novos = maior;
+                    f->cap = cap;
+                }
+                f->novos[f->tam++] = w;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Compara dois índices de vértice (para qsort).
  */
 
-bool guardarGrafo(Grafo* g, const char* nomeFicheiro) {
-    if (!g) return false;
+static int compararIndices(const void* a, const void* b) {
+    int32_t x = *(const int32_t*)a;
+    int32_t y = *(const int32_t*)b;
+    return (x > y) - (x < y);
+}
 
-    FILE* f = fopen(nomeFicheiro, "w");
-    if (!f) return false;
+/**
+ * @brief Junta os vértices descobertos pelos fios no próximo nível da ordem de visita.
+ * 
+ * Os vértices do novo nível são copiados para o fim de c->ordem e, se o nível
+ * foi expandido por vários fios, ordenados por índice, para que a ordem não
+ * dependa de qual fio os reclamou. Esse troço de c->ordem passa a ser a nova
+ * fronteira.
+ * 
+ * @param t Trabalho partilhado.
+ * @param fios Estado dos fios.
+ * @param numThreads Número de fios.
+ * @param paralelo true se o nível foi expandido por mais de um fio.
+ */
 
-    Vertice* v = g->vertices;
-    while (v) {
-        // Exemplo de formato: x y freq
-        fprintf(f, "%d %d %c\n", v->x, v->y, v->freq);
-        v = v->prox;
+static void juntarNivelBFS(TrabalhoBFS* t, FioBFS* fios, int numThreads, bool paralelo) {
+    GrafoCSR* c = t->c;
+    int32_t inicioNivel = c->num_visitados;
+    for (int k = 0; k < numThreads; k++) {
+        if (fios[k].tam) memcpy(c->ordem + c->num_visitados, fios[k].novos, fios[k].tam * sizeof(int32_t));
+        c->num_visitados += (int32_t)fios[k].tam;
+        fios[k].tam = 0;
     }
-
-    fclose(f);
-    return true;
+    int32_t tam = c->num_visitados - inicioNivel;
+    if (paralelo && tam > 1) qsort(c->ordem + inicioNivel, (size_t)tam, sizeof(int32_t), compararIndices);
+    t->fronteira = c->ordem + inicioNivel;
+    t->tam_fronteira = tam;
+    t->nivel_atual++;
+    atomic_store_explicit(&t->proximo, 0, memory_order_relaxed);
 }
 
 /**
- * @brief Procura um vértice no grafo pelo seu identificador único.
+ * @brief Ciclo de cada fio auxiliar: expande um nível de cada vez que a barreira abre.
  * 
- * Percorre a lista de vértices do grafo procurando um vértice cujo
- * campo `id` seja igual ao valor fornecido.
+ * @param arg FioBFS do fio.
  * 
- * @param g Ponteiro para o grafo onde a procura será realizada.
- * @param id Identificador único do vértice a encontrar.
- * 
- * @return Ponteiro para o vértice com o id correspondente, ou NULL se não existir.
+ * @return NULL.
  */
 
-Vertice* encontrarVerticePorID(Grafo* g, int id) {
-    Vertice* v = g->vertices;
-    while (v) {
-        if (v->id == id) return v;
-        v = v->prox;
+static void* fioBFS(void* arg) {
+    FioBFS* f = arg;
+    TrabalhoBFS* t = f->t;
+    for (;;) {
+        barreiraEsperar(&t->barreira); // início de um nível (ou fim da travessia)
+        if (t->terminou) break;
+        expandirNivelBFS(f);
+        barreiraEsperar(&t->barreira); // nível acabado
     }
     return NULL;
 }
 
 /**
- * @brief Insere uma aresta da origem para o destino no grafo.
+ * @brief Faz uma BFS paralela, nível a nível, sobre um grafo CSR.
  * 
- * Adiciona uma aresta na lista de adjacência do vértice de origem
- * que aponta para o vértice de destino, evitando duplicatas.
+ * A fronteira de cada nível é repartida pelos fios em blocos; cada vértice é
+ * reclamado com uma operação atómica sobre o seu nível, e no fim do nível os
+ * vértices novos são ordenados por índice. O nível de cada vértice é a sua
+ * distância (em arestas) à origem e não depende do número de fios nem da ordem
+ * em que correm; coincide com a distância dada por bfsCSR.
  * 
- * @param origem Ponteiro para o vértice de origem.
- * @param destino Ponteiro para o vértice de destino.
+ * O vetor de níveis é do instantâneo e é reaproveitado entre consultas. A ordem
+ * de visita fica em c->ordem, nível a nível. Níveis com menos de
+ * BFS_FRONTEIRA_MINIMA vértices são expandidos só pelo fio que chamou (para não
+ * pagar a sincronização em grafos longos e estreitos), pela ordem da fronteira;
+ * os restantes ficam ordenados por índice. Assim, a ordem é sempre a mesma para
+ * o mesmo número de fios, e com um só fio é a mesma de bfsCSR.
  * 
- * @return true se a aresta foi inserida com sucesso, false caso contrário
- *         (por exemplo, se a aresta já existir ou falha na alocação).
+ * @param c Ponteiro para o instantâneo.
+ * @param x Coordenada X do vértice de partida.
+ * @param y Coordenada Y do vértice de partida.
+ * @param numThreads Número de fios a usar (valores menores que 1 contam como 1).
+ * @param niveis Vetor de c->num_vertices posições que recebe o nível de cada vértice,
+ *               ou -1 se não for alcançado (pode ser NULL).
+ * 
+ * @return true se a travessia foi feita, false se o vértice não existir ou falhar a alocação.
  */
 
-bool inserirAresta(Vertice* origem, Vertice* destino) {
-    if (!origem || !destino) return false;
+bool bfsParaleloCSR(GrafoCSR* c, int x, int y, int numThreads, int32_t* niveis) {
+    if (!c) return false;
+    if (numThreads < 1) numThreads = 1;
+    novaEpocaCSR(c);
 
-    // Evitar aresta duplicada
-    Aresta* atual = origem->arestas;
-    while (atual) {
-        if (atual->destino == destino) return false; // já existe
-        atual = atual->prox;
+    int32_t inicio = ProcurarVerticeCSR(c, x, y);
+    if (inicio < 0) return false;
+
+    size_t n = (size_t)c->num_vertices;
+    TrabalhoBFS t;
+    t.c = c;
+    if (!c->nivel) c->nivel = malloc(n * sizeof(atomic_int)); // reservado na primeira consulta
+    t.nivel = c->nivel;
+    FioBFS* fios = calloc((size_t)numThreads, sizeof(FioBFS));
+    pthread_t* ids = numThreads > 1 ? malloc((size_t)(numThreads - 1) * sizeof(pthread_t)) : NULL;
+    if (!t.nivel || !fios || (numThreads > 1 && !ids) || !barreiraIniciar(&t.barreira, numThreads)) {
+        free(fios);
+        free(ids);
+        return false;
     }
+    for (size_t i = 0; i < n; i++) atomic_init(&t.nivel[i], -1);
+    atomic_init(&t.nivel[inicio], 0);
+    atomic_init(&t.proximo, 0);
+    c->ordem[c->num_visitados++] = inicio;
+    t.fronteira = c->ordem;
+    t.tam_fronteira = 1;
+    t.nivel_atual = 0;
+    t.terminou = false;
 
-    Aresta* nova = malloc(sizeof(Aresta));
-    if (!nova) return false;
+    int criados = 0;
+    for (int k = 0; k < numThreads; k++) fios[k].t = &t;
+    for (int k = 1; k < numThreads; k++) {
+        if (pthread_create(&ids[k - 1], NULL, fioBFS, &fios[k]) != 0) break;
+        criados++;
+    }
+    int ativos = criados + 1;
+    if (ativos < numThreads) { // os fios que não foi possível criar não chegam à barreira
+        pthread_mutex_lock(&t.barreira.mutex);
+        t.barreira.total = ativos;
+        pthread_mutex_unlock(&t.barreira.mutex);
+    }
 
-    nova->destino = destino;
-    nova->prox = origem->arestas;
-    origem->arestas = nova;
+    while (t.tam_fronteira > 0) {
+        bool paralelo = ativos > 1 && t.tam_fronteira >= BFS_FRONTEIRA_MINIMA;
+        if (!paralelo) { // nível pequeno: sem sincronizar
+            expandirNivelBFS(&fios[0]);
+        } else {
+            barreiraEsperar(&t.barreira); // acorda os fios para este nível
+            expandirNivelBFS(&fios[0]);
+            barreiraEsperar(&t.barreira); // espera que todos acabem
+        }
+        juntarNivelBFS(&t, fios, ativos, paralelo);
+    }
+    t.terminou = true;
+    if (ativos > 1) barreiraEsperar(&t.barreira); // liberta os fios, que veem terminou
+    for (int k = 0; k < criados; k++) pthread_join(ids[k], NULL);
 
-    return true;
+    bool erro = false;
+    for (int k = 0; k < numThreads; k++) {
+        erro = erro || fios[k].erro;
+        free(fios[k].novos);
+    }
+    for (int32_t i = 0; i < c->num_visitados; i++) c->marca[c->ordem[i]] = c->epoca;
+    if (niveis) {
+        for (size_t i = 0; i < n; i++) niveis[i] = atomic_load_explicit(&t.nivel[i], memory_order_relaxed);
+    }
+
+    barreiraDestruir(&t.barreira);
+    free(fios);
+    free(ids);
+    return !erro;
 }
 
+#define ALCANCE_BITS 64 ///< Origens tratadas de uma vez pela BFS com bits (uma por bit de uint64_t)
+
 /**
- * @brief Remove a aresta da origem para o destino no grafo.
+ * @brief Verifica se todas as arestas de um grafo CSR existem nos dois sentidos.
  * 
- * Procura e remove a aresta que conecta o vértice origem ao vértice destino
- * na lista de adjacência do vértice origem.
+ * Para cada vértice, marca os seus vizinhos e confirma que todos os vértices
+ * que o têm como vizinho estão marcados e que são tantos como os vizinhos.
+ * Usa um CSR transposto temporário e corre em O(V + E).
  * 
- * @param origem Ponteiro para o vértice de origem.
- * @param destino Ponteiro para o vértice de destino.
+ * @param c Ponteiro para o instantâneo.
+ * @param simetrico Recebe o resultado.
  * 
- * @return true se a aresta foi encontrada e removida, false caso contrário.
+ * @return true se a verificação foi feita, false se falhar a alocação.
  */
 
-bool removerAresta(Vertice* origem, Vertice* destino) {
-    if (!origem || !destino) return false;
+static bool csrSimetrico(GrafoCSR* c, bool* simetrico) {
+    size_t n = (size_t)c->num_vertices;
+    int32_t* inicioT = calloc(n + 1, sizeof(int32_t));
+    int32_t* origens = malloc((c->num_arestas ? (size_t)c->num_arestas : 1) * sizeof(int32_t));
+    int32_t* carimbo = malloc((n ? n : 1) * sizeof(int32_t));
+    if (!inicioT || !origens || !carimbo) {
+        free(inicioT);
+        free(origens);
+        free(carimbo);
+        return false;
+    }
 
-    Aresta* atual = origem->arestas;
-    Aresta* anterior = NULL;
+    for (int32_t k = 0; k < c->num_arestas; k++) inicioT[c->vizinhos[k] + 1]++;
+    for (size_t v = 0; v < n; v++) inicioT[v + 1] += inicioT[v];
+    for (int32_t u = 0; u < c->num_vertices; u++) { // o transposto fica com as origens de cada vértice
+        for (int32_t k = c->inicio[u]; k < c->inicio[u + 1]; k++) origens[inicioT[c->vizinhos[k]]++] = u;
+    }
+    for (size_t v = n; v > 0; v--) inicioT[v] = inicioT[v - 1]; // repõe os inícios
+    inicioT[0] = 0;
 
-    while (atual) {
-        if (atual->destino == destino) {
-            if (anterior) anterior->prox = atual->prox;
-            else origem->arestas = atual->prox;
-            free(atual);
-            return true;
+    for (size_t v = 0; v < n; v++) carimbo[v] = -1;
+    *simetrico = true;
+    for (int32_t v = 0; v < c->num_vertices && *simetrico; v++) {
+        if (c->inicio[v + 1] - c->inicio[v] != inicioT[v + 1] - inicioT[v]) {
+            *simetrico = false;
+            break;
+        }
+        for (int32_t k = c->inicio[v]; k < c->inicio[v + 1]; k++) carimbo[c->vizinhos[k]] = v;
+        for (int32_t k = inicioT[v]; k < inicioT[v + 1]; k++) {
+            if (carimbo[origens[k]] != v) { // u -> v sem v -> u
+                *simetrico = false;
+                break;
+            }
         }
-        anterior = atual;
-        atual = atual->prox;
     }
 
-    return false;
+    free(inicioT);
+    free(origens);
+    free(carimbo);
+    return true;
 }
 
 /**
- * @brief Liga vértices que têm a mesma frequência no grafo.
+ * @brief Acrescenta espaço a membros de um resultado de alcance.
  * 
- * Percorre todos os pares de vértices no grafo e cria arestas bidirecionais 
- * entre os vértices que possuem a mesma frequência, desde que a frequência
- * não seja '#' ou '.'.
- * 
- * @param g Ponteiro para o grafo.
+ * @param r Resultado.
+ * @param cap Capacidade atual de membros (atualizada).
+ * @param precisa Número total de membros que têm de caber.
  * 
- * @return true se pelo menos uma nova aresta foi adicionada, false caso contrário.
+ * @return true se couber, false se falhar a alocação.
  */
 
-bool ligarVerticesComMesmaFrequencia(Grafo* g) {
-    bool modificou = false;
-    for (Vertice* v1 = g->vertices; v1 != NULL; v1 = v1->prox) {
-        for (Vertice* v2 = v1->prox; v2 != NULL; v2 = v2->prox) {
-            if (v1->freq == v2->freq && v1->freq != '#' && v1->freq != '.') {
-                if (inserirAresta(v1, v2)) modificou = true;
-                if (inserirAresta(v2, v1)) modificou = true;
-            }
-        }
-    }
-    return modificou;
+static bool reservarMembros(AlcanceMultiplo* r, size_t* cap, size_t precisa) {
+    if (precisa <= *cap) return true;
+    size_t novo = *cap ? *cap : 256;
+    while (novo < precisa) novo *= 2;
+    int32_t* maior = realloc(r->membros, novo * sizeof(int32_t));
+    if (!maior) return false;
+    r->membros = maior;
+    *cap = novo;
+    return true;
 }
 
 /**
- * @brief Gera uma representação em matriz do grafo como uma string.
- * 
- * Cria uma matriz 2D representada por uma string onde cada linha termina com '\n' e 
- * a matriz contém os caracteres das frequências dos vértices nas suas posições (x, y).
- * As posições sem vértices são preenchidas com '.'.
+ * @brief Responde ao alcance por etiquetas de componentes (grafo simétrico).
  * 
- * A string resultante deve ser libertada pelo chamador para evitar memory leaks.
+ * Num grafo em que todas as arestas têm os dois sentidos, o que se alcança a
+ * partir de uma origem é a sua componente. As componentes são etiquetadas com
+ * uma só passagem e cada componente com origens dá um conjunto, partilhado por
+ * todas as origens que caem nela.
  * 
- * @param g Ponteiro para o grafo.
+ * @param c Ponteiro para o instantâneo.
+ * @param origem Índice CSR de cada origem (-1 se não existir).
+ * @param r Resultado a preencher (conjunto_de já alocado).
  * 
- * @return Ponteiro para uma string alocada dinamicamente contendo a matriz do grafo,
- *         ou NULL em caso de falha na alocação.
+ * @return true se correu bem, false se falhar a alocação.
  */
 
-char* gerarMatrizGrafo(Grafo* g) {
-    int maxX = 0, maxY = 0;
-    for (Vertice* v = g->vertices; v != NULL; v = v->prox) {
-        if (v->x > maxX) maxX = v->x;
-        if (v->y > maxY) maxY = v->y;
-    }
-
-    int linhas = maxY + 1;
-    int colunas = maxX + 1;
-    int tamanho = linhas * (colunas + 1) + 1;
+static bool alcancePorComponentes(GrafoCSR* c, const int32_t* origem, AlcanceMultiplo* r) {
+    size_t n = (size_t)c->num_vertices;
+    int32_t* comp = malloc((n ? n : 1) * sizeof(int32_t));
+    int32_t* fila = malloc((n ? n : 1) * sizeof(int32_t));
+    int32_t* conjuntoDaComp = malloc((n ? n : 1) * sizeof(int32_t));
+    bool ok = comp && fila && conjuntoDaComp;
 
-    char* buffer = malloc(tamanho);
-    if (!buffer) return NULL;
+    if (ok) {
+        for (size_t v = 0; v < n; v++) comp[v] = -1;
+        int32_t numComp = 0;
+        for (int32_t s = 0; s < c->num_vertices; s++) { // etiqueta cada componente com uma BFS
+            if (comp[s] >= 0) continue;
+            int32_t frente = 0, fim = 0;
+            fila[fim++] = s;
+            comp[s] = numComp;
+            while (frente < fim) {
+                int32_t v = fila[frente++];
+                for (int32_t k = c->inicio[v]; k < c->inicio[v + 1]; k++) {
+                    int32_t w = c->vizinhos[k];
+                    if (comp[w] < 0) {
+                        comp[w] = numComp;
+                        fila[fim++] = w;
+                    }
+                }
+            }
+            numComp++;
+        }
 
-    for (int y = 0; y < linhas; y++) {
-        for (int x = 0; x < colunas; x++) {
-            buffer[y * (colunas + 1) + x] = '.';
+        for (int32_t k = 0; k < numComp; k++) conjuntoDaComp[k] = -1;
+        for (int32_t k = 0; k < r->num_origens; k++) { // um conjunto por componente com origens
+            if (origem[k] < 0) continue;
+            int32_t* conj = &conjuntoDaComp[comp[origem[k]]];
+            if (*conj < 0) *conj = r->num_conjuntos++;
+            r->conjunto_de[k] = *conj;
         }
-        buffer[y * (colunas + 1) + colunas] = '\n';
-    }
-    buffer[tamanho - 1] = '\0';
 
-    for (Vertice* v = g->vertices; v != NULL; v = v->prox) {
-        buffer[v->y * (colunas + 1) + v->x] = v->freq;
+        r->inicio = calloc((size_t)r->num_conjuntos + 1, sizeof(size_t));
+        ok = r->inicio != NULL;
+        if (ok) {
+            for (size_t v = 0; v < n; v++) {
+                int32_t conj = conjuntoDaComp[comp[v]];
+                if (conj >= 0) r->inicio[conj + 1]++;
+            }
+            for (int32_t j = 0; j < r->num_conjuntos; j++) r->inicio[j + 1] += r->inicio[j];
+            size_t total = r->inicio[r->num_conjuntos];
+            r->membros = malloc((total ? total : 1) * sizeof(int32_t));
+            ok = r->membros != NULL;
+        }
+        if (ok) {
+            for (size_t v = 0; v < n; v++) { // por ordem de índice: cada conjunto fica ordenado
+                int32_t conj = conjuntoDaComp[comp[v]];
+                if (conj >= 0) r->membros[r->inicio[conj]++] = (int32_t)v;
+            }
+            for (int32_t j = r->num_conjuntos; j > 0; j--) r->inicio[j] = r->inicio[j - 1]; // repõe os inícios
+            r->inicio[0] = 0;
+        }
     }
 
-    return buffer;
+    free(comp);
+    free(fila);
+    free(conjuntoDaComp);
+    return ok;
 }
 
 /**
- * @brief Reseta o campo de visitação de todos os vértices do grafo para zero.
+ * @brief Responde ao alcance com uma BFS com bits, 64 origens de cada vez.
  * 
- * Percorre todos os vértices do grafo e define o campo `visita` como 0, indicando
- * que nenhum vértice está marcado como visitado. Também reinicia o campo `topo` do grafo para 1.
+ * Cada vértice tem uma palavra de 64 bits com as origens do lote que já o
+ * alcançaram e outra com as que ainda falta propagar a partir dele. Um vértice
+ * entra na fila quando ganha bits por propagar, e cada visita passa todos esses
+ * bits aos vizinhos de uma vez; assim um lote de 64 origens custa no máximo
+ * tanto como 64 BFS, e em geral muito menos, porque os caminhos comuns são
+ * percorridos uma só vez. Origens repetidas partilham o mesmo conjunto.
  * 
- * @param g Ponteiro para o grafo.
+ * @param c Ponteiro para o instantâneo.
+ * @param origem Índice CSR de cada origem (-1 se não existir).
+ * @param r Resultado a preencher (conjunto_de já alocado).
  * 
- * @return true se a operação foi bem-sucedida, false se o ponteiro do grafo for NULL.
+ * @return true se correu bem, false se falhar a alocação.
  */
 
-bool limparVisitados(Grafo* g) {
-    if (g == NULL) return false; // falhou porque o grafo não existe
-    
-    Vertice* atual = g->vertices;
-    while (atual != NULL) {
-        atual->visita = 0;
-        atual = atual->prox;
+static bool alcancePorBits(GrafoCSR* c, const int32_t* origem, AlcanceMultiplo* r) {
+    size_t n = (size_t)c->num_vertices;
+    uint64_t* alcancado = calloc(n ? n : 1, sizeof(uint64_t));
+    uint64_t* pendente = calloc(n ? n : 1, sizeof(uint64_t));
+    int32_t* fila = malloc((n ? n : 1) * sizeof(int32_t));
+    int32_t* conjuntoDoVertice = malloc((n ? n : 1) * sizeof(int32_t));
+    int32_t* loteOrigem = malloc(ALCANCE_BITS * sizeof(int32_t));
+    r->inicio = malloc(((size_t)r->num_origens + 1) * sizeof(size_t));
+    bool ok = alcancado && pendente && fila && conjuntoDoVertice && loteOrigem && r->inicio;
+    size_t capMembros = 0;
+
+    if (ok) {
+        for (size_t v = 0; v < n; v++) conjuntoDoVertice[v] = -1;
+        r->inicio[0] = 0;
     }
-    g->topo = 1;
-    return true; // sucesso
+    int32_t k = 0;
+    while (ok && k < r->num_origens) {
+        // junta até 64 origens ainda sem conjunto
+        int bits = 0;
+        for (; k < r->num_origens && bits < ALCANCE_BITS; k++) {
+            if (origem[k] < 0) continue;
+            int32_t* conj = &conjuntoDoVertice[origem[k]];
+            if (*conj < 0) { // primeira vez que esta origem aparece
+                *conj = r->num_conjuntos + bits;
+                loteOrigem[bits++] = origem[k];
+            }
+            r->conjunto_de[k] = *conj;
+        }
+        if (bits == 0) break;
+
+        // propaga os bits até não haver nada pendente
+        size_t frente = 0, tam = 0;
+        for (int b = 0; b < bits; b++) {
+            int32_t s = loteOrigem[b];
+            alcancado[s] |= (uint64_t)1 << b;
+            if (!pendente[s]) fila[(frente + tam++) % n] = s;
+            pendente[s] |= (uint64_t)1 << b;
+        }
+        while (tam > 0) {
+            int32_t v = fila[frente];
+            frente = (frente + 1) % n;
+            tam--;
+            uint64_t passa = pendente[v];
+            pendente[v] = 0;
+            for (int32_t a = c->inicio[v]; a < c->inicio[v + 1]; a++) {
+                int32_t w = c->vizinhos[a];
+                uint64_t novos = passa & ~alcancado[w];
+                if (!novos) continue;
+                alcancado[w] |= novos;
+                if (!pendente[w]) fila[(frente + tam++) % n] = w; // cada vértice está no máximo uma vez na fila
+                pendente[w] |= novos;
+            }
+        }
+
+        // conta os membros de cada bit e copia-os por ordem de índice
+        size_t conta[ALCANCE_BITS] = { 0 };
+        for (size_t v = 0; v < n; v++) {
+            for (uint64_t m = alcancado[v]; m; m &= m - 1) conta[__builtin_ctzll(m)]++;
+        }
+        size_t cursor[ALCANCE_BITS];
+        for (int b = 0; b < bits; b++) {
+            cursor[b] = r->inicio[r->num_conjuntos + b];
+            r->inicio[r->num_conjuntos + b + 1] = cursor[b] + conta[b];
+        }
+        ok = reservarMembros(r, &capMembros, r->inicio[r->num_conjuntos + bits]);
+        if (!ok) break;
+        for (size_t v = 0; v < n; v++) {
+            for (uint64_t m = alcancado[v]; m; m &= m - 1) r->membros[cursor[__builtin_ctzll(m)]++] = (int32_t)v;
+            alcancado[v] = 0; // pronto para o lote seguinte
+        }
+        r->num_conjuntos += bits;
+    }
+
+    free(alcancado);
+    free(pendente);
+    free(fila);
+    free(conjuntoDoVertice);
+    free(loteOrigem);
+    return ok;
 }
 
 /**
- * @brief Executa a busca em profundidade (DFS) recursiva a partir de um vértice.
+ * @brief Calcula os vértices alcançáveis a partir de várias origens, numa só passagem do motor.
  * 
- * Marca o vértice atual como visitado atribuindo um número sequencial de visitação,
- * e recursa para todos os vértices adjacentes ainda não visitados.
+ * Substitui chamar bfsCSR (e limpar as marcas) uma vez por origem. Se todas as
+ * arestas do grafo existirem nos dois sentidos, a resposta vem das componentes
+ * ligadas, calculadas uma vez; caso contrário é usada uma BFS com bits que trata
+ * 64 origens em simultâneo. Em ambos os casos cada origem recebe um conjunto, e
+ * origens com o mesmo resultado (a mesma componente, ou a mesma antena) partilham-no.
  * 
- * @param v Ponteiro para o vértice atual da DFS.
- * @param g Ponteiro para o grafo, usado para atualizar o contador de visitação.
+ * @param c Ponteiro para o instantâneo.
+ * @param coordenadas Vetor com 2 * numOrigens inteiros (x, y de cada origem).
+ * @param numOrigens Número de origens.
  * 
- * @return true se o vértice foi visitado com sucesso, false se o vértice for NULL ou já visitado.
+ * @return AlcanceMultiplo* O resultado (libertar com libertarAlcanceMultiplo), ou NULL se falhar a alocação.
  */
 
-bool dfsRecursivo(Vertice* v, Grafo* g) {
-    if (v == NULL || v->visita != 0) return false;
+AlcanceMultiplo* alcanceMultiploCSR(GrafoCSR* c, const int* coordenadas, int32_t numOrigens) {
+    if (!c || (!coordenadas && numOrigens > 0) || numOrigens < 0) return NULL;
 
-    v->visita = g->topo++;
+    AlcanceMultiplo* r = calloc(1, sizeof(AlcanceMultiplo));
+    int32_t* origem = malloc((numOrigens ? (size_t)numOrigens : 1) * sizeof(int32_t));
+    if (r) r->conjunto_de = malloc((numOrigens ? (size_t)numOrigens : 1) * sizeof(int32_t));
+    bool simetrico = false;
+    if (!r || !origem || !r->conjunto_de || !csrSimetrico(c, &simetrico)) {
+        free(origem);
+        return libertarAlcanceMultiplo(r);
+    }
 
-    Aresta* a = v->arestas;
-    while (a != NULL) {
-        dfsRecursivo(a->destino, g);
-        a = a->prox;
+    r->num_origens = numOrigens;
+    for (int32_t k = 0; k < numOrigens; k++) {
+        origem[k] = ProcurarVerticeCSR(c, coordenadas[2 * k], coordenadas[2 * k + 1]);
+        r->conjunto_de[k] = -1;
     }
-    return true;  // sucesso em visitar este vértice
+    r->por_componentes = simetrico;
+    bool ok = simetrico ? alcancePorComponentes(c, origem, r) : alcancePorBits(c, origem, r);
+
+    free(origem);
+    if (!ok) return libertarAlcanceMultiplo(r);
+    return r;
 }
 
 /**
- * @brief Inicia a busca em profundidade (DFS) no grafo a partir do vértice nas coordenadas (x, y).
+ * @brief Dá acesso aos vértices alcançados por uma das origens de um AlcanceMultiplo.
  * 
- * Esta função limpa o estado de visitação dos vértices, procura o vértice inicial
- * com as coordenadas especificadas e chama a função recursiva de DFS para visitar
- * todos os vértices alcançáveis a partir dele.
- * 
- * @param g Ponteiro para o grafo onde a DFS será realizada.
- * @param x Coordenada x do vértice inicial.
- * @param y Coordenada y do vértice inicial.
+ * @param r Resultado de alcanceMultiploCSR.
+ * @param k Número da origem (pela ordem em que foi pedida).
+ * @param membros Recebe o ponteiro para os índices CSR alcançados, por ordem crescente (pode ser NULL).
  * 
- * @return true se a DFS foi iniciada e executada com sucesso, false caso contrário
- *         (grafo inválido, vértice inicial não encontrado, falha ao limpar visitas).
+ * @return int32_t Número de vértices alcançados (incluindo a origem), 0 se a origem não existir, ou -1 se k for inválido.
  */
 
-bool dfs(Grafo* g, int x, int y) {
-    if (!limparVisitados(g)) return false;
-
-    Vertice* inicio = ProcurarVertice(g, x, y);
-    if (inicio == NULL) return false;
-
-    dfsRecursivo(inicio, g);
-    return true;
+int32_t alcancadosDe(const AlcanceMultiplo* r, int32_t k, const int32_t** membros) {
+    if (!r || k < 0 || k >= r->num_origens) return -1;
+    int32_t j = r->conjunto_de[k];
+    if (j < 0) {
+        if (membros) *membros = NULL;
+        return 0;
+    }
+    if (membros) *membros = r->membros + r->inicio[j];
+    return (int32_t)(r->inicio[j + 1] - r->inicio[j]);
 }
 
 /**
- * @brief Adiciona um vértice ao final da fila ligada.
+ * @brief Liberta um resultado de alcanceMultiploCSR.
  * 
- * Esta função cria um novo elemento de fila contendo o vértice dado
- * e o adiciona ao final da lista ligada que representa a fila.
- * Se a fila estiver vazia (ponteiro *f é NULL), o novo elemento passa a ser o primeiro.
- * 
- * @param f Ponteiro para o ponteiro da fila (lista ligada) onde o vértice será adicionado.
- * @param v Ponteiro para o vértice a ser adicionado à fila.
+ * @param r Resultado (pode ser NULL).
  * 
- * @return true se a operação foi bem-sucedida, false se falhou na alocação de memória.
+ * @return NULL, para limpar o ponteiro de quem chama.
  */
 
-bool adicionarAFila(Fila** f, Vertice* v) {
-    Fila* novo = malloc(sizeof(Fila));
-    if (novo == NULL) {
-        return false;  // falha ao alocar memória
-    }
-    novo->v = v;
-    novo->prox = NULL;
-    if (*f == NULL) {
-        *f = novo;
-    } else {
-        Fila* temp = *f;
-        while (temp->prox) temp = temp->prox;
-        temp->prox = novo;
-    }
-    return true;  // sucesso
+AlcanceMultiplo* libertarAlcanceMultiplo(AlcanceMultiplo* r) {
+    if (!r) return NULL;
+    free(r->conjunto_de);
+    free(r->inicio);
+    free(r->membros);
+    free(r);
+    return NULL;
 }
 
 /**
- * @brief Remove e retorna o primeiro vértice da fila ligada.
- * 
- * Esta função remove o primeiro elemento da fila (lista ligada)
- * e retorna o ponteiro para o vértice armazenado nesse elemento.
- * Se a fila estiver vazia, retorna NULL.
+ * @brief Distância entre dois vértices de um grafo CSR.
  * 
- * @param f Ponteiro para o ponteiro da fila (lista ligada) de onde o vértice será removido.
+ * @param c Ponteiro para o instantâneo.
+ * @param a Índice do primeiro vértice.
+ * @param b Índice do segundo vértice.
+ * @param tipo Medida de distância.
  * 
- * @return Ponteiro para o vértice removido, ou NULL se a fila estiver vazia.
+ * @return double A distância.
  */
 
-Vertice* removerDaFila(Fila** f) {
-    if (*f == NULL) return NULL;
-    Fila* temp = *f;
-    *f = temp->prox;
-    Vertice* v = temp->v;
-    free(temp);
-    return v;
+static double distanciaCSR(const GrafoCSR* c, int32_t a, int32_t b, TipoDistancia tipo) {
+    double dx = (double)c->xs[a] - (double)c->xs[b];
+    double dy = (double)c->ys[a] - (double)c->ys[b];
+    if (tipo == DISTANCIA_MANHATTAN) return fabs(dx) + fabs(dy);
+    return sqrt(dx * dx + dy * dy);
 }
 
 /**
- * @brief Executa uma busca em largura (BFS) no grafo a partir do vértice com coordenadas (x, y).
+ * @brief Acrescenta uma entrada ao heap de um grafo CSR.
  * 
- * A função inicializa os estados de visita dos vértices, localiza o vértice inicial,
- * e realiza a BFS marcando a ordem de visitação em cada vértice.
- * 
- * @param g Ponteiro para o grafo onde a busca será realizada.
- * @param x Coordenada X do vértice inicial.
- * @param y Coordenada Y do vértice inicial.
+ * @param c Ponteiro para o instantâneo.
+ * @param tam Número de entradas no heap (atualizado).
+ * @param chave Prioridade da entrada (menor sai primeiro).
+ * @param v Vértice.
  * 
- * @return true se a busca foi executada com sucesso, false caso o vértice inicial não seja encontrado.
+ * @return true se foi acrescentada, false se falhar a alocação.
  */
 
-bool bfs(Grafo* g, int x, int y) {
-    limparVisitados(g);
-    Vertice* inicio = ProcurarVertice(g, x, y);
-    if (inicio == NULL) return false;  // Não encontrou o vértice inicial
-
-    Fila* fila = NULL;
-    adicionarAFila(&fila, inicio);
-    inicio->visita = g->topo++;
-
-    while (fila != NULL) {
-        Vertice* atual = removerDaFila(&fila);
-        Aresta* a = atual->arestas;
-        while (a != NULL) {
-            if (a->destino->visita == 0) {
-                a->destino->visita = g->topo++;
-                adicionarAFila(&fila, a->destino);
-            }
-            a = a->prox;
-        }
+static bool heapInserir(GrafoCSR* c, size_t* tam, double chave, int32_t v) {
+    if (*tam == c->heap_cap) {
+        size_t cap = c->heap_cap ? c->heap_cap * 2 : 256;
+        EntradaHeap* maior = realloc(c->heap, cap * sizeof(EntradaHeap));
+        if (!maior) return false;
+        c->heap = maior;
+        c->heap_cap = cap;
     }
-    return true;  // Busca executada com sucesso
+    size_t i = (*tam)++;
+    while (i > 0 && c->heap[(i - 1) / 2].chave > chave) { // sobe enquanto o pai for maior
+        c->heap[i] = c->heap[(i - 1) / 2];
+        i = (i - 1) / 2;
+    }
+    c->heap[i].chave = chave;
+    c->heap[i].v = v;
+    return true;
 }
 
 /**
- * @brief Mostra a ordem de visita dos vértices no grafo.
- * 
- * Percorre todos os vértices do grafo e imprime aqueles que foram visitados,
- * exibindo suas coordenadas, frequência e a ordem em que foram visitados.
+ * @brief Retira a entrada de menor chave do heap de um grafo CSR.
  * 
- * @param g Ponteiro para o grafo.
+ * @param c Ponteiro para o instantâneo.
+ * @param tam Número de entradas no heap (maior que 0; atualizado).
  * 
- * @return true se pelo menos um vértice foi visitado e exibido, false caso contrário.
+ * @return EntradaHeap A entrada retirada.
  */
 
-bool mostrarcaminho(Grafo* g) {
-    bool encontrou = false;
-    printf("Ordem de visita dos vértices:\n");
-    Vertice* atual = g->vertices;
-    while (atual != NULL) {
-        if (atual->visita != 0) {
-            printf("Antena em (%d, %d), Freq: %c, Ordem: %d\n", 
-                   atual->x, atual->y, atual->freq, atual->visita);
-            encontrou = true;
-        }
-        atual = atual->prox;
+static EntradaHeap heapRetirar(GrafoCSR* c, size_t* tam) {
+    EntradaHeap topo = c->heap[0];
+    EntradaHeap ultimo = c->heap[--(*tam)];
+    size_t i = 0;
+    for (;;) { // desce o último elemento a partir da raiz
+        size_t filho = 2 * i + 1;
+        if (filho >= *tam) break;
+        if (filho + 1 < *tam && c->heap[filho + 1].chave < c->heap[filho].chave) filho++;
+        if (c->heap[filho].chave >= ultimo.chave) break;
+        c->heap[i] = c->heap[filho];
+        i = filho;
     }
-    return encontrou;
+    if (*tam > 0) c->heap[i] = ultimo;
+    return topo;
 }
 
 /**
- * @brief Lê arestas de um ficheiro binário e adiciona ao grafo.
+ * @brief Calcula o caminho mais curto entre duas antenas (Dijkstra ou A*) num grafo CSR.
  * 
- * O ficheiro binário deve conter sequências de 4 inteiros representando
- * as coordenadas (x1, y1) e (x2, y2) de duas antenas (vértices) que
- * serão ligadas por uma aresta.
+ * O peso de cada aresta é a distância (euclidiana ou de Manhattan) entre as
+ * coordenadas das duas antenas. A fila de prioridade é um heap binário com
+ * inserções repetidas (as entradas antigas são descartadas quando saem), e a
+ * procura para logo que o destino sai do heap. Com usarAEstrela, a prioridade
+ * soma a distância em linha reta (na mesma medida) até ao destino; como esta
+ * estimativa nunca excede o custo real, o caminho continua a ser o mais curto,
+ * mas são fechados menos vértices.
  * 
- * Para cada par de coordenadas lidas, procura os vértices no grafo e,
- * se existirem, adiciona uma aresta entre eles.
+ * Os vetores de custos e pais, o heap e as marcas são do instantâneo e são
+ * reaproveitados (por épocas) entre consultas, pelo que cada consulta só toca
+ * nos vértices que realmente alcança. Os vértices fechados ficam em c->ordem,
+ * pela ordem em que foram fechados (ver mostrarcaminhoCSR).
  * 
- * @param g Ponteiro para o grafo onde as arestas serão adicionadas.
- * @param nomeFicheiro Nome do ficheiro binário a ser lido.
+ * @param c Ponteiro para o instantâneo.
+ * @param xOrig Coordenada X da origem.
+ * @param yOrig Coordenada Y da origem.
+ * @param xDest Coordenada X do destino.
+ * @param yDest Coordenada Y do destino.
+ * @param tipo Medida de distância usada como peso (e estimativa, no A*).
+ * @param usarAEstrela true para A*, false para Dijkstra.
+ * @param caminho Vetor onde são escritos os índices CSR do caminho, da origem ao destino (pode ser NULL).
+ * @param capCaminho Capacidade de caminho; se o caminho não couber, nada é escrito.
+ * @param custo Recebe o custo total do caminho (pode ser NULL).
  * 
- * @return Ponteiro para o grafo atualizado.
+ * @return int32_t Número de vértices do caminho, 0 se o destino não for alcançável,
+ *         ou -1 se alguma das antenas não existir ou falhar a alocação.
  */
 
-Grafo* LerArestasBinario(Grafo* g, const char* nomeFicheiro) {
-    FILE* f = fopen(nomeFicheiro, "rb");
-    if (!f) {
-        perror("Erro ao abrir ficheiro de arestas");
-        return g;
-    }
+int32_t caminhoMaisCurtoCSR(GrafoCSR* c, int xOrig, int yOrig, int xDest, int yDest, TipoDistancia tipo,
+                            bool usarAEstrela, int32_t* caminho, int32_t capCaminho, double* custo) {
+    if (!c) return -1;
+    novaEpocaCSR(c);
+    int32_t origem = ProcurarVerticeCSR(c, xOrig, yOrig);
+    int32_t destino = ProcurarVerticeCSR(c, xDest, yDest);
+    if (origem < 0 || destino < 0) return -1;
 
-    int x1, y1, x2, y2;
-    while (fread(&x1, sizeof(int), 1, f) == 1 &&
-           fread(&y1, sizeof(int), 1, f) == 1 &&
-           fread(&x2, sizeof(int), 1, f) == 1 &&
-           fread(&y2, sizeof(int), 1, f) == 1) {
+    size_t n = (size_t)c->num_vertices;
+    if (!c->custo) c->custo = malloc(n * sizeof(double)); // reservados na primeira consulta
+    if (!c->pai) c->pai = malloc(n * sizeof(int32_t));
+    if (!c->custo || !c->pai) return -1;
 
-        Vertice* v1 = ProcurarVertice(g, x1, y1);
-        Vertice* v2 = ProcurarVertice(g, x2, y2);
-        if (v1 && v2) {
-            bool rs = false;
-            AdicionarAresta(g, v1->x, v1->y, v2->x, v2->y, &rs);
+    // marca == epoca: custo e pai válidos nesta consulta
+    size_t tam = 0;
+    c->marca[origem] = c->epoca;
+    c->custo[origem] = 0.0;
+    c->pai[origem] = -1;
+    if (!heapInserir(c, &tam, usarAEstrela ? distanciaCSR(c, origem, destino, tipo) : 0.0, origem)) return -1;
+
+    bool chegou = false;
+    while (tam > 0) {
+        EntradaHeap e = heapRetirar(c, &tam);
+        int32_t v = e.v;
+        double estimativa = usarAEstrela ? distanciaCSR(c, v, destino, tipo) : 0.0;
+        if (e.chave > c->custo[v] + estimativa) continue; // entrada antiga: v já saiu com um custo menor
+        // um vértice só volta a sair se o arredondamento da estimativa o reabrir: não cabe outra vez em ordem
+        if (c->num_visitados < c->num_vertices) c->ordem[c->num_visitados++] = v;
+        if (v == destino) { // paragem antecipada
+            chegou = true;
+            break;
+        }
+        for (int32_t k = c->inicio[v]; k < c->inicio[v + 1]; k++) {
+            int32_t w = c->vizinhos[k];
+            double novo = c->custo[v] + distanciaCSR(c, v, w, tipo);
+            if (c->marca[w] == c->epoca && c->custo[w] <= novo) continue;
+            c->marca[w] = c->epoca;
+            c->custo[w] = novo;
+            c->pai[w] = v;
+            if (!heapInserir(c, &tam, novo + (usarAEstrela ? distanciaCSR(c, w, destino, tipo) : 0.0), w)) return -1;
         }
     }
+    if (!chegou) return 0;
 
-    fclose(f);
-    return g;
+    int32_t passos = 0;
+    for (int32_t v = destino; v >= 0; v = c->pai[v]) passos++;
+    if (caminho && passos <= capCaminho) {
+        int32_t i = passos;
+        for (int32_t v = destino; v >= 0; v = c->pai[v]) caminho[--i] = v; // do destino para trás
+    }
+    if (custo) *custo = c->custo[destino];
+    return passos;
 }
 
 /**
- * @brief Guarda as arestas do grafo num ficheiro binário.
- * 
- * Percorre todos os vértices do grafo e escreve no ficheiro as
- * arestas, evitando duplicação ao gravar apenas quando o id do
- * vértice de origem é menor que o id do vértice destino.
+ * @brief Escreve os contadores e tempos da instrumentação do grafo, em texto ou JSON.
  * 
- * Cada aresta é representada por quatro inteiros correspondentes às
- * coordenadas (x, y) do vértice origem e do vértice destino.
+ * Os contadores só existem quando o projeto é compilado com GRAFO_ESTATISTICAS
+ * (make OPCOES=-DGRAFO_ESTATISTICAS); sem essa opção não há nada a escrever e a
+ * função devolve false sem tocar no ficheiro. Os tempos de cada fase somam só as
+ * execuções completas, e os nós alocados e libertados são os dos pools do grafo.
  * 
- * @param g Ponteiro para o grafo cujas arestas serão guardadas.
- * @param nomeFicheiro Nome do ficheiro binário onde as arestas serão escritas.
+ * @param g Ponteiro para o grafo.
+ * @param f Ficheiro onde escrever (por exemplo stdout ou stderr).
+ * @param json true para um objeto JSON numa linha, false para texto com um valor por linha.
  * 
- * @return true se a operação for bem sucedida, false caso contrário.
+ * @return true se as estatísticas foram escritas, false se g ou f forem NULL ou a instrumentação estiver desligada.
  */
 
-bool GuardarArestasBinario(Grafo* g, const char* nomeFicheiro) {
-    FILE* f = fopen(nomeFicheiro, "wb");
-    if (!f) {
-        return false;
+bool imprimirEstatisticas(Grafo* g, FILE* f, bool json) {
+    if (!g || !f) return false;
+#ifdef GRAFO_ESTATISTICAS
+    static const char* const fases[NUM_FASES] = { "leitura", "nefasto", "ligacao", "travessia", "instantaneo" };
+    const EstatisticasGrafo* e = &g->estat;
+    const PoolNos* pools[3] = { &g->pool_vertices, &g->pool_arestas, &g->pool_fila };
+    uint64_t alocados = 0, libertados = 0;
+    for (int k = 0; k < 3; k++) {
+        alocados += pools[k]->alocados;
+        libertados += pools[k]->libertados;
     }
+    const char* nomes[] = { "procuras", "sondagens", "nos_percorridos", "alocacoes", "libertacoes",
+                            "arestas_inseridas", "arestas_duplicadas", "passos_travessia", "vizinhos_percorridos" };
+    uint64_t valores[] = { e->procuras, e->sondagens, e->nos_percorridos, alocados, libertados,
+                           e->arestas_inseridas, e->arestas_duplicadas, e->passos_travessia, e->vizinhos_percorridos };
+    size_t num = sizeof(valores) / sizeof(valores[0]);
 
-    Vertice* v = g->vertices;
-    while (v) {
-        Aresta* a = v->arestas;
-        while (a) {
-            if (v->id < a->destino->id) {
-                fwrite(&v->x, sizeof(int), 1, f);
-                fwrite(&v->y, sizeof(int), 1, f);
-                fwrite(&a->destino->x, sizeof(int), 1, f);
-                fwrite(&a->destino->y, sizeof(int), 1, f);
-            }
-            a = a->prox;
+    if (json) {
+        fputc('{', f);
+        for (size_t k = 0; k < num; k++) fprintf(f, "\"%s\":%llu,", nomes[k], (unsigned long long)valores[k]);
+        fputs("\"fases\":{", f);
+        for (int k = 0; k < NUM_FASES; k++) {
+            fprintf(f, "%s\"%s\":{\"chamadas\":%llu,\"ns\":%llu}", k ? "," : "", fases[k],
+                    (unsigned long long)e->chamadas[k], (unsigned long long)e->tempo_ns[k]);
+        }
+        fputs("}}\n", f);
+    } else {
+        for (size_t k = 0; k < num; k++) fprintf(f, "%-22s %llu\n", nomes[k], (unsigned long long)valores[k]);
+        for (int k = 0; k < NUM_FASES; k++) {
+            fprintf(f, "fase %-17s %llu chamadas, %.3f ms\n", fases[k],
+                    (unsigned long long)e->chamadas[k], e->tempo_ns[k] / 1e6);
         }
-        v = v->prox;
     }
+    return !ferror(f);
+#else
+    (void)json;
+    return false;
+#endif
+}
 
-    fclose(f);
+/**
+ * @brief Põe a zero os contadores e tempos da instrumentação do grafo.
+ * 
+ * Permite medir só uma parte do trabalho (por exemplo, só as travessias depois
+ * de carregar o mapa). Sem GRAFO_ESTATISTICAS não faz nada.
+ * 
+ * @param g Ponteiro para o grafo.
+ * 
+ * @return true se os contadores foram limpos, false se g for NULL ou a instrumentação estiver desligada.
+ */
+
+bool limparEstatisticas(Grafo* g) {
+    if (!g) return false;
+#ifdef GRAFO_ESTATISTICAS
+    memset(&g->estat, 0, sizeof(g->estat));
+    PoolNos* pools[3] = { &g->pool_vertices, &g->pool_arestas, &g->pool_fila };
+    for (int k = 0; k < 3; k++) {
+        pools[k]->alocados = 0;
+        pools[k]->libertados = 0;
+    }
     return true;
+#else
+    return false;
+#endif
 }
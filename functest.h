@@ -6,6 +6,7 @@
 #include <stdlib.h>
 #include <stdbool.h>
 #include <string.h>
+#include <stdint.h>
 
 
 /// @brief Estrutura que representa uma antena (vértice)
@@ -13,23 +14,293 @@ typedef struct Vertice {
     int id;
     int x, y;                  ///< Coordenadas únicas da antena
     char freq;                 ///< Frequência da antena
-    int visita;
+    unsigned int marca;        ///< Época da última travessia que visitou o vértice (ver Grafo::epoca)
+    int pos;                   ///< Posição do vértice no último instantâneo CSR (ver CongelarGrafo)
     struct Vertice* prox;
+    struct Vertice* ant;       ///< Vértice anterior na lista do grafo (NULL no primeiro)
     struct Aresta* arestas;    ///< Lista de arestas ligadas a esta antena
+    struct Aresta* entradas;   ///< Arestas que chegam a esta antena (destino = vértice de origem)
+    struct Grafo* dono;        ///< Grafo a que o vértice pertence (dá acesso aos pools de memória)
+    struct Vertice* uf_pai;    ///< Pai na floresta union-find das componentes (o próprio se for raiz)
+    int uf_rank;               ///< Limite superior da altura da árvore (união por rank)
+    int uf_tamanho;            ///< Número de vértices da componente (só válido na raiz)
+    int pos_grupo;             ///< Posição do vértice no grupo da sua frequência (Grafo::grupos)
+    int pos_celula;            ///< Posição do vértice na sua célula da grelha espacial (Grafo::celulas)
+    uint64_t carimbo;          ///< Marca temporária de inserirLote e das remoções (comparada com Grafo::carimbo_lote)
+    int pos_lote;              ///< Grupo do vértice, como origem, no lote em curso de inserirLote
+    struct Aresta* suprimidas; ///< Ligações implícitas removidas a partir deste vértice (modo implícito)
+    struct Aresta* entradas_suprimidas; ///< Ligações implícitas removidas que chegam a este vértice (destino = origem)
 } Vertice;
 
 /// @brief Estrutura que representa uma ligação (aresta) entre antenas
 typedef struct Aresta {
     Vertice* destino;          ///< Ponteiro para o vértice de destino
     struct Aresta* prox;       ///< Próxima aresta na lista
+    struct Aresta* ant;        ///< Aresta anterior na lista (NULL na primeira)
+    struct Aresta* par;        ///< A mesma ligação na outra lista (aresta <-> entrada, suprimida <-> entrada suprimida)
 } Aresta;
 
+/// @brief Cabeçalho de um bloco (slab) de nós de um pool; os nós vêm a seguir
+typedef struct Slab {
+    struct Slab* prox;         ///< Slab alocado anteriormente
+} Slab;
+
+/// @brief Pool de nós de tamanho fixo, alocados em slabs e reutilizados através de uma lista livre
+typedef struct PoolNos {
+    size_t tamanho_no;         ///< Tamanho de cada nó em bytes
+    size_t nos_por_slab;       ///< Número de nós do próximo slab a alocar (cresce até um limite)
+    Slab* slabs;               ///< Lista de slabs alocados
+    void* livres;              ///< Lista de nós libertados, reutilizados antes de gastar o slab atual
+    char* atual;               ///< Próximo nó ainda por usar no slab mais recente
+    size_t restantes;          ///< Nós ainda por usar no slab mais recente
+    size_t num_slabs;          ///< Número de slabs alocados
+#ifdef GRAFO_ESTATISTICAS
+    uint64_t alocados;         ///< Nós entregues por poolAlocar
+    uint64_t libertados;       ///< Nós devolvidos por poolLibertar
+#endif
+} PoolNos;
+
+/// @brief Fila circular de vértices sobre um vetor pré-alocado (enfileirar e desenfileirar em O(1))
+typedef struct FilaCircular {
+    Vertice** itens;           ///< Vetor com os elementos
+    int capacidade;            ///< Número máximo de elementos
+    int inicio;                ///< Posição do primeiro elemento
+    int tamanho;               ///< Número de elementos na fila
+} FilaCircular;
+
+/// @brief Iterador sobre os vizinhos de um vértice (arestas explícitas e, no modo implícito, o grupo de frequência)
+typedef struct IteradorVizinhos {
+    Vertice* v;                ///< Vértice cujos vizinhos são percorridos
+    struct Aresta* a;          ///< Próxima aresta explícita
+    int i;                     ///< Próxima posição no grupo de frequência de v
+} IteradorVizinhos;
+
+/// @brief Nível da pilha da DFS iterativa: o vértice e o ponto onde ficou a exploração dos vizinhos
+typedef struct PassoDFS {
+    IteradorVizinhos it;       ///< Vizinhos de it.v ainda por tentar
+} PassoDFS;
+
+#define GRELHA_BITS 4                 ///< As células da grelha espacial têm 2^GRELHA_BITS unidades de lado
+#define GRELHA_LADO (1 << GRELHA_BITS) ///< Lado de cada célula da grelha espacial
+
+/// @brief Célula da grelha espacial: antenas cujas coordenadas caem num quadrado GRELHA_LADO x GRELHA_LADO
+typedef struct CelulaEspacial {
+    int cx, cy;                ///< Coordenadas da célula (x >> GRELHA_BITS, y >> GRELHA_BITS)
+    bool usada;                ///< false numa posição livre da tabela
+    Vertice** membros;         ///< Antenas da célula (ordem não garantida)
+    int tamanho;               ///< Número de membros
+    int cap;                   ///< Capacidade do vetor
+} CelulaEspacial;
+
+/// @brief Fases do trabalho sobre o grafo medidas pela instrumentação (GRAFO_ESTATISTICAS)
+typedef enum FaseGrafo {
+    FASE_LEITURA,              ///< LerFicheiro
+    FASE_NEFASTO,              ///< deduzirNefasto / deduzirNefastoParalelo
+    FASE_LIGACAO,              ///< ligarVerticesComMesmaFrequencia
+    FASE_TRAVESSIA,            ///< bfs e dfs
+    FASE_INSTANTANEO,          ///< GuardarInstantaneo e CarregarInstantaneo
+    NUM_FASES
+} FaseGrafo;
+
+/// @brief Contadores e tempos da instrumentação, guardados no grafo quando GRAFO_ESTATISTICAS está definido
+///
+/// Os nós alocados e libertados não estão aqui: são contados em cada PoolNos
+/// e somados por imprimirEstatisticas.
+typedef struct EstatisticasGrafo {
+    uint64_t procuras;             ///< Chamadas a ProcurarVertice
+    uint64_t sondagens;            ///< Posições do índice de coordenadas inspecionadas por essas procuras
+    uint64_t nos_percorridos;      ///< Nós de listas (arestas, suprimidas, vértices) percorridos à procura de um elemento
+    uint64_t arestas_inseridas;    ///< Ligações criadas (uma a uma ou em lote)
+    uint64_t arestas_duplicadas;   ///< Ligações rejeitadas por já existirem
+    uint64_t passos_travessia;     ///< Vértices visitados por bfs, dfs e dfsRecursivo
+    uint64_t vizinhos_percorridos; ///< Vizinhos devolvidos por proximoVizinho
+    uint64_t chamadas[NUM_FASES];  ///< Execuções completas de cada fase
+    uint64_t tempo_ns[NUM_FASES];  ///< Tempo acumulado de cada fase, em nanossegundos
+} EstatisticasGrafo;
+
+/// @brief Antenas com uma dada frequência, num vetor contíguo
+typedef struct GrupoFrequencia {
+    Vertice** membros;         ///< Vértices do grupo (ordem não garantida depois de remoções)
+    int tamanho;               ///< Número de membros
+    int cap;                   ///< Capacidade do vetor
+    unsigned int epoca;        ///< Época da travessia a que se refere o cursor
+    int cursor;                ///< Na travessia dessa época, os membros antes do cursor já foram visitados
+} GrupoFrequencia;
+
+/// @brief Posição da tabela de ligações suprimidas (Grafo::suprimidas): a ligação origem -> no->destino
+typedef struct LigacaoSuprimida {
+    Vertice* origem;           ///< Vértice de origem (NULL numa posição livre)
+    struct Aresta* no;         ///< Nó da ligação na lista de suprimidas da origem
+} LigacaoSuprimida;
+
 typedef struct Grafo{
     Vertice* vertices;
     int num_vertices;          ///< Contador do número de vértices
-    int topo;  // auxiliar para ordem de visitadoos
+    int proximo_id;            ///< Identificador a atribuir ao próximo vértice criado (se não houver ids livres)
+    Vertice** por_id;          ///< Tabela densa id -> vértice (NULL nos ids que não estão em uso)
+    int por_id_cap;            ///< Capacidade da tabela por_id
+    int* ids_livres;           ///< Pilha dos ids libertados por RemoverVertice, reutilizados antes de proximo_id
+    int ids_livres_tam;        ///< Número de ids na pilha
+    int ids_livres_cap;        ///< Capacidade da pilha
+    unsigned int epoca;        ///< Época da travessia atual: um vértice está visitado se marca == epoca
+    uint64_t carimbo_lote;     ///< Último valor dado a Vertice::carimbo (inserirLote, remoções de vértices)
+    Vertice** percurso;        ///< Ordem de visita da última travessia (dfs/bfs)
+    int percurso_tam;          ///< Número de vértices visitados na última travessia
+    int percurso_cap;          ///< Capacidade do vetor percurso
+    bool componentes_validas;  ///< false depois de remoções: as componentes são recalculadas na próxima consulta
+    GrupoFrequencia grupos[256]; ///< Membros de cada frequência (indexado pelo carácter)
+    bool arestas_implicitas;   ///< Modo implícito: antenas com a mesma frequência são vizinhas sem arestas guardadas
+    LigacaoSuprimida* suprimidas; ///< Tabela de dispersão das ligações implícitas removidas, indexada por (origem, destino)
+    size_t suprimidas_cap;     ///< Capacidade da tabela (potência de 2, 0 se ainda não alocada)
+    size_t suprimidas_usadas;  ///< Número de posições ocupadas na tabela
+    CelulaEspacial* celulas;   ///< Grelha espacial: tabela de dispersão das células ocupadas
+    size_t celulas_cap;        ///< Capacidade da tabela (potência de 2, 0 se vazia)
+    size_t celulas_usadas;     ///< Células criadas (as que ficam vazias não são apagadas)
+    int largura;               ///< Largura do mapa lido por LerFicheiro (0 se desconhecida)
+    int altura;                ///< Altura (número de linhas) do mapa lido por LerFicheiro (0 se desconhecida)
+    Vertice** indice;          ///< Tabela de dispersão (endereçamento aberto) indexada pelas coordenadas (x, y)
+    size_t indice_cap;         ///< Capacidade da tabela (sempre potência de 2, ou 0 se ainda não alocada)
+    size_t indice_usados;      ///< Número de posições ocupadas na tabela
+    PoolNos pool_vertices;     ///< Memória dos vértices
+    PoolNos pool_arestas;      ///< Memória das arestas
+    PoolNos pool_fila;         ///< Memória dos nós de Fila
+    FilaCircular fila_bfs;     ///< Fila reutilizada entre chamadas a bfs
+    PassoDFS* pilha_dfs;       ///< Pilha explícita reutilizada entre chamadas a dfs
+    int pilha_dfs_cap;         ///< Capacidade da pilha (cresce quando é preciso)
+#ifdef GRAFO_ESTATISTICAS
+    EstatisticasGrafo estat;   ///< Contadores da instrumentação (só existem com GRAFO_ESTATISTICAS)
+#endif
 } Grafo;
 
+/// @brief Entrada da fila de prioridade (heap binário) usada por caminhoMaisCurtoCSR
+typedef struct EntradaHeap {
+    double chave;              ///< Custo conhecido até ao vértice (mais a estimativa, no A*)
+    int32_t v;                 ///< Índice do vértice
+} EntradaHeap;
+
+/// @brief Medida de distância entre antenas usada como peso das arestas
+typedef enum TipoDistancia {
+    DISTANCIA_EUCLIDIANA,      ///< sqrt(dx² + dy²)
+    DISTANCIA_MANHATTAN        ///< |dx| + |dy|
+} TipoDistancia;
+
+/// @brief Instantâneo compacto do grafo em formato CSR (compressed sparse row)
+///
+/// Os vizinhos do vértice i estão em vizinhos[inicio[i]] .. vizinhos[inicio[i + 1] - 1].
+/// Os atributos dos vértices estão guardados em vetores separados (xs, ys, freqs, ids),
+/// pela mesma ordem da lista de vértices do grafo no momento em que foi congelado.
+/// Quando aberto com AbrirInstantaneoCSR, estes vetores apontam para o ficheiro mapeado
+/// (só de leitura) e apenas marca e ordem são memória própria.
+typedef struct GrafoCSR {
+    int32_t num_vertices;      ///< Número de vértices do instantâneo
+    int32_t num_arestas;       ///< Número total de arestas (entradas em vizinhos)
+    int32_t* inicio;           ///< Deslocamentos de cada vértice em vizinhos (num_vertices + 1 posições)
+    int32_t* vizinhos;         ///< Índices dos vértices de destino, contíguos
+    int32_t* xs;               ///< Coordenada X de cada vértice
+    int32_t* ys;               ///< Coordenada Y de cada vértice
+    char* freqs;               ///< Frequência de cada vértice
+    int32_t* ids;              ///< Identificador original de cada vértice
+    int32_t* tabela;           ///< Tabela de dispersão das coordenadas (índice + 1, 0 = posição livre)
+    size_t tabela_cap;         ///< Capacidade da tabela (potência de 2)
+    unsigned int* marca;       ///< Época da última travessia que visitou cada vértice
+    unsigned int epoca;        ///< Época da travessia atual
+    int32_t* ordem;            ///< Índices dos vértices pela ordem de visita da última travessia
+    int32_t num_visitados;     ///< Número de vértices em ordem
+    const char* ficheiro;      ///< Conteúdo do instantâneo de onde vêm os vetores (NULL se congelado de um Grafo)
+    size_t ficheiro_tamanho;   ///< Tamanho desse conteúdo
+    bool ficheiro_mapeado;     ///< true se o conteúdo é um mmap, false se foi lido para um buffer
+    double* custo;             ///< Custo do melhor caminho conhecido até cada vértice (válido se marca == epoca)
+    int32_t* pai;              ///< Vértice anterior nesse caminho (-1 na origem)
+    EntradaHeap* heap;         ///< Fila de prioridade reutilizada entre consultas
+    size_t heap_cap;           ///< Capacidade do heap
+    int32_t* pilha;            ///< Pilha de dfsCSR ou fila de bfsCSR, reutilizada entre consultas
+    int32_t* cursor;           ///< Próximo vizinho a tentar em cada nível da pilha de dfsCSR
+    _Atomic int* nivel;        ///< Nível de cada vértice em bfsParaleloCSR, reutilizado entre consultas
+} GrafoCSR;
+
+/// @brief Resultado de uma consulta de alcance com várias origens (alcanceMultiploCSR)
+///
+/// Cada origem k aponta para um conjunto (conjunto_de[k]); origens com o mesmo
+/// resultado partilham o conjunto. Os vértices alcançados pelo conjunto j são
+/// membros[inicio[j]] .. membros[inicio[j + 1] - 1], índices CSR por ordem crescente.
+typedef struct AlcanceMultiplo {
+    int32_t num_origens;       ///< Número de origens pedidas
+    int32_t* conjunto_de;      ///< Conjunto de cada origem (-1 se a origem não existir no grafo)
+    int32_t num_conjuntos;     ///< Número de conjuntos distintos
+    size_t* inicio;            ///< Deslocamentos de cada conjunto em membros (num_conjuntos + 1 posições)
+    int32_t* membros;          ///< Vértices alcançados, conjunto a conjunto
+    bool por_componentes;      ///< true se foi respondido com etiquetas de componentes (grafo simétrico)
+} AlcanceMultiplo;
+
+/// @brief Camadas do mapa de ocupação (gerarMapaOcupacao)
+typedef enum CamadaOcupacao {
+    CAMADA_ANTENAS,            ///< Antenas com frequência (tudo menos '#')
+    CAMADA_NEFASTOS,           ///< Pontos nefastos ('#')
+    NUM_CAMADAS
+} CamadaOcupacao;
+
+/// @brief Mapa de ocupação de uma janela do mapa: 1 bit por posição e por camada
+///
+/// A posição (x0 + x, y0 + y) da camada k é o bit x % 64 de
+/// bits[(k * altura + y) * palavras_por_linha + x / 64].
+typedef struct MapaOcupacao {
+    int x0, y0;                ///< Canto superior esquerdo da janela
+    int largura, altura;       ///< Dimensões da janela
+    size_t palavras_por_linha; ///< Palavras de 64 bits por linha de cada camada
+    uint64_t* bits;            ///< NUM_CAMADAS * altura * palavras_por_linha palavras
+} MapaOcupacao;
+
+#define ESCRITOR_BUFFER (1 << 20)     ///< Tamanho do buffer de um EscritorSaida (bytes despejados de cada vez)
+
+/// @brief Escritor de texto com buffer próprio, despejado em blocos grandes
+///
+/// O destino é um FILE*, um descritor de ficheiro ou a memória. No modo de
+/// memória o buffer cresce e guarda todo o texto, até ser retirado com
+/// retirarTextoEscritor.
+typedef struct EscritorSaida {
+    char* buffer;              ///< Texto ainda por despejar (ou todo o texto, no modo de memória)
+    size_t usados;             ///< Bytes ocupados no buffer
+    size_t capacidade;         ///< Tamanho do buffer
+    FILE* ficheiro;            ///< Destino FILE* (NULL se não for o destino)
+    int fd;                    ///< Descritor de destino (-1 se não for o destino)
+    bool memoria;              ///< true se o texto fica em memória
+    bool erro;                 ///< true se alguma escrita ou alocação falhou
+} EscritorSaida;
+
+#define INSTANTANEO_MAGIA "ANTGRAF"   ///< Assinatura no início de um ficheiro de instantâneo (8 bytes com o '\0')
+#define INSTANTANEO_VERSAO 1          ///< Versão atual do formato do instantâneo
+#define INSTANTANEO_SECOES 7          ///< Número de secções de dados do instantâneo
+
+/// @brief Cabeçalho de um ficheiro de instantâneo binário do grafo
+///
+/// O ficheiro guarda o grafo em formato CSR, com os vértices e as arestas por índice
+/// (nunca por ponteiro), em secções contíguas alinhadas a 8 bytes e pela ordem:
+/// xs, ys, ids (int32), freqs (char), inicio (int32, num_vertices + 1), vizinhos
+/// (int32) e a tabela de dispersão das coordenadas (int32, tabela_cap posições).
+/// Os inteiros estão na ordem de bytes da máquina que escreveu o ficheiro.
+typedef struct CabecalhoInstantaneo {
+    char magia[8];             ///< INSTANTANEO_MAGIA
+    uint32_t versao;           ///< INSTANTANEO_VERSAO
+    uint32_t crc;              ///< CRC-32 de tudo o que vem depois do cabeçalho
+    int32_t num_vertices;      ///< Número de vértices
+    int32_t num_arestas;       ///< Número de entradas em vizinhos
+    int32_t largura;           ///< Largura do mapa de origem
+    int32_t altura;            ///< Altura do mapa de origem
+    int32_t proximo_id;        ///< Próximo identificador a atribuir
+    uint32_t tabela_cap;       ///< Capacidade da tabela de dispersão (potência de 2)
+    uint64_t tamanho;          ///< Tamanho total do ficheiro em bytes
+    uint64_t secoes[INSTANTANEO_SECOES]; ///< Deslocamento de cada secção desde o início do ficheiro
+} CabecalhoInstantaneo;
+
+/// @brief Verificações feitas por AbrirInstantaneoCSR antes de usar um instantâneo
+typedef enum VerificacaoInstantaneo {
+    VERIFICAR_CABECALHO,       ///< Só o cabeçalho, em O(1): apenas para ficheiros de confiança
+    VERIFICAR_INDICES,         ///< Também os índices, em O(V + E + tabela_cap)
+    VERIFICAR_TUDO             ///< Também o CRC do ficheiro inteiro
+} VerificacaoInstantaneo;
+
+#define LOTE_SEM_MEMORIA ((size_t)-1) ///< Devolvido pelas inserções em lote quando falta memória (e nada foi inserido)
+
 typedef struct Fila {
     Vertice* v;
     struct Fila* prox;
@@ -42,32 +313,78 @@ Vertice* ProcurarVertice(Grafo* g, int x, int y) ;
 
 Grafo* AdicionarVertice(Grafo* g, int x, int y, char freq, bool* sucesso) ;
 
+int procurarNoRetangulo(Grafo* g, int x0, int y0, int x1, int y1, Vertice** resultado, int capResultado);
+
+int procurarNoRaio(Grafo* g, int x, int y, int raio, Vertice** resultado, int capResultado);
+
+Vertice* antenaMaisProxima(Grafo* g, int x, int y, char freq);
+
 bool LibertarListaArestas(Aresta* a) ;
 
 Grafo* RemoverAresta(Grafo* g, int xOrig, int yOrig, int xDest, int yDest, bool* sucesso) ;
 
 Grafo* RemoverVertice(Grafo* g, int x, int y, bool* sucesso) ;
+
+size_t RemoverVerticesEmLote(Grafo* g, const int* coordenadas, size_t numVertices);
 Grafo* AdicionarAresta(Grafo* g, int xOrig, int yOrig, int xDest, int yDest, bool* sucesso) ;
 
+size_t AdicionarArestasEmLote(Grafo* g, const int* coordenadas, size_t numArestas);
+
 Grafo* DestruirGrafo(Grafo* g, bool* sucesso) ;
 Grafo* LerFicheiro(Grafo* g, const char* nomeFicheiro, bool* sucesso);
 bool guardarGrafo(Grafo* g, const char* nomeFicheiro) ;
+bool guardarGrafoEscritor(Grafo* g, EscritorSaida* e);
 Vertice* listarAntenas(Grafo* g, int* contador);
+bool listarAntenasEscritor(Grafo* g, EscritorSaida* e, int* contador);
 bool deduzirNefasto(Grafo* g);
+bool deduzirNefastoParalelo(Grafo* g, int numThreads, bool limitarAoMapa);
+bool ProcessarMapaPorFaixas(const char* ficheiroEntrada, const char* ficheiroSaida, int alturaFaixa, size_t* numNefastos);
 
 Vertice* encontrarVerticePorID(Grafo* g, int id) ;
 
+bool compactarIds(Grafo* g);
+
 bool inserirAresta(Vertice* origem, Vertice* destino);
 
+size_t inserirArestasEmLote(Grafo* g, Vertice** pares, size_t numPares);
+
 bool removerAresta(Vertice* origem, Vertice* destino);
 
 bool ligarVerticesComMesmaFrequencia(Grafo* g);
 
+size_t ligarMesmaFrequencia(Grafo* g);
+
+bool ativarArestasImplicitas(Grafo* g);
+
+bool iniciarVizinhos(IteradorVizinhos* it, Vertice* v);
+
+Vertice* proximoVizinho(IteradorVizinhos* it);
+
+Vertice* componenteDe(Grafo* g, Vertice* v);
+
+int idComponente(Grafo* g, int x, int y);
+
+bool mesmaComponente(Grafo* g, int x1, int y1, int x2, int y2);
+
+int tamanhoComponente(Grafo* g, int x, int y);
+
 char* gerarMatrizGrafo(Grafo* g);
 
+char* gerarMatrizJanela(Grafo* g, int x0, int y0, int largura, int altura, size_t* tamanho);
+
+MapaOcupacao* gerarMapaOcupacao(Grafo* g, int x0, int y0, int largura, int altura);
+
+bool posicaoOcupada(const MapaOcupacao* m, CamadaOcupacao camada, int x, int y);
+
+MapaOcupacao* libertarMapaOcupacao(MapaOcupacao* m);
+
 
 bool limparVisitados(Grafo* g) ;
 
+bool foiVisitado(Grafo* g, Vertice* v);
+
+Vertice** ordemVisita(Grafo* g, int* total);
+
 bool dfsRecursivo(Vertice* v, Grafo* g) ;
 
 bool dfs(Grafo* g, int x, int y) ;
@@ -76,6 +393,14 @@ bool adicionarAFila(Fila** f, Vertice* v) ;
 
 Vertice* removerDaFila(Fila** f) ;
 
+bool criarFilaCircular(FilaCircular* f, int capacidade);
+
+bool libertarFilaCircular(FilaCircular* f);
+
+bool enfileirar(FilaCircular* f, Vertice* v);
+
+Vertice* desenfileirar(FilaCircular* f);
+
 bool bfs(Grafo* g, int x, int y) ;
 
 bool mostrarcaminho(Grafo* g);
@@ -84,4 +409,59 @@ Grafo* LerArestasBinario(Grafo* g, const char* nomeFicheiro) ;
 
 bool GuardarArestasBinario(Grafo* g, const char* nomeFicheiro);
 
+Grafo* LerArestasPorID(Grafo* g, const char* nomeFicheiro);
+
+bool GuardarArestasPorID(Grafo* g, const char* nomeFicheiro);
+
+GrafoCSR* CongelarGrafo(Grafo* g);
+
+GrafoCSR* DestruirGrafoCSR(GrafoCSR* c);
+
+int32_t ProcurarVerticeCSR(GrafoCSR* c, int x, int y);
+
+bool listarAntenasCSR(GrafoCSR* c, int* contador);
+
+bool listarAntenasCSREscritor(GrafoCSR* c, EscritorSaida* e, int* contador);
+
+bool dfsCSR(GrafoCSR* c, int x, int y);
+
+bool bfsCSR(GrafoCSR* c, int x, int y);
+
+bool mostrarcaminhoCSR(GrafoCSR* c);
+
+bool bfsParaleloCSR(GrafoCSR* c, int x, int y, int numThreads, int32_t* niveis);
+
+int32_t caminhoMaisCurtoCSR(GrafoCSR* c, int xOrig, int yOrig, int xDest, int yDest, TipoDistancia tipo,
+                            bool usarAEstrela, int32_t* caminho, int32_t capCaminho, double* custo);
+
+AlcanceMultiplo* alcanceMultiploCSR(GrafoCSR* c, const int* coordenadas, int32_t numOrigens);
+
+int32_t alcancadosDe(const AlcanceMultiplo* r, int32_t k, const int32_t** membros);
+
+AlcanceMultiplo* libertarAlcanceMultiplo(AlcanceMultiplo* r);
+
+int32_t vizinhosCSR(GrafoCSR* c, int32_t i, const int32_t** vizinhos);
+
+bool GuardarInstantaneo(Grafo* g, const char* nomeFicheiro);
+
+Grafo* CarregarInstantaneo(Grafo* g, const char* nomeFicheiro, bool* sucesso);
+
+GrafoCSR* AbrirInstantaneoCSR(const char* nomeFicheiro, VerificacaoInstantaneo verificacao);
+
+bool escritorFicheiro(EscritorSaida* e, FILE* f);
+
+bool escritorDescritor(EscritorSaida* e, int fd);
+
+bool escritorMemoria(EscritorSaida* e);
+
+bool despejarEscritor(EscritorSaida* e);
+
+bool fecharEscritor(EscritorSaida* e);
+
+char* retirarTextoEscritor(EscritorSaida* e, size_t* tamanho);
+
+bool imprimirEstatisticas(Grafo* g, FILE* f, bool json);
+
+bool limparEstatisticas(Grafo* g);
+
 #endif /* EDBD263F_EDE2_44A9_BADA_FF5F2E5385E2 */
@@ -30,9 +30,11 @@ grafo = RemoverAresta(grafo, 4, 4, 5, 2, &result);
 
     
     GuardarArestasBinario(grafo , "arestas.bin");
+    GuardarInstantaneo(grafo, "grafo.bin"); // vértices e arestas, para um arranque rápido com CarregarInstantaneo
 
+    GrafoCSR* csr = CongelarGrafo(grafo); // instantâneo compacto para a listagem e os percursos
     int contador = 0;
-listarAntenas(grafo, &contador);
+listarAntenasCSR(csr, &contador);
     char* matriz = gerarMatrizGrafo(grafo);
     if (matriz) {
         fputs(matriz, stdout);  // Aqui faz a impressão
@@ -44,11 +46,12 @@ listarAntenas(grafo, &contador);
     int x = 5;
     int y = 2;
 
-    bfs(grafo, x, y);
-    mostrarcaminho(grafo);
+    bfsCSR(csr, x, y);
+    mostrarcaminhoCSR(csr);
 
-    dfs(grafo, x, y);
-    mostrarcaminho(grafo);
+    dfsCSR(csr, x, y);
+    mostrarcaminhoCSR(csr);
+    csr = DestruirGrafoCSR(csr);
 
 
     if (guardarGrafo(grafo, "resultado.txt"))
@@ -56,6 +59,8 @@ listarAntenas(grafo, &contador);
         printf("\nFicheiro guardado");
     }
 
+    imprimirEstatisticas(grafo, stderr, false); // só escreve se compilado com GRAFO_ESTATISTICAS
+
     grafo = DestruirGrafo(grafo, &sucesso);
     if (!sucesso)
     {
@@ -0,0 +1,91 @@
+/**
+ * @file teste.c
+ * @brief Verificações automáticas da biblioteca do grafo.
+ *
+ * Cada verificação devolve true se passar; o programa escreve o nome das que
+ * falharem e termina com código 1 se houver alguma. Corre com make teste, e
+ * com make teste OPCOES=-fsanitize=address as escritas fora dos vetores também
+ * são detetadas.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <limits.h>
+#include "functest.h"
+
+/**
+ * @brief Confirma que a listagem com buffer escreve o mesmo que o printf, no pior caso.
+ *
+ * Lista antenas com coordenadas INT_MIN (as linhas mais compridas possíveis) para
+ * um escritor em memória a que faltam entre 0 e 63 bytes para encher, de forma a
+ * passar por todos os limites do buffer. Compilado com OPCOES=-fsanitize=address,
+ * qualquer escrita fora do buffer é detetada.
+ *
+ * @return true se todas as listagens forem iguais às do printf.
+ */
+
+static bool verificarEscritor(void) {
+    bool sucesso;
+    Grafo* g = CriarGrafo();
+    if (!g) return false;
+    AdicionarVertice(g, INT_MIN, INT_MIN, 'A', &sucesso);
+    AdicionarVertice(g, INT_MIN, INT_MIN + 1, 'A', &sucesso);
+    AdicionarVertice(g, INT_MAX, INT_MIN, '#', &sucesso);
+    ligarVerticesComMesmaFrequencia(g);
+
+    char esperado[512];
+    int n = 0;
+    for (Vertice* v = g->vertices; v != NULL; v = v->prox) {
+        n += snprintf(esperado + n, sizeof(esperado) - (size_t)n, "Antena (%d, %d) [%c] -> ", v->x, v->y, v->freq);
+        for (Aresta* a = v->arestas; a != NULL; a = a->prox) {
+            Vertice* d = a->destino;
+            n += snprintf(esperado + n, sizeof(esperado) - (size_t)n, "%c(%d, %d) ", d->freq, d->x, d->y);
+        }
+        n += snprintf(esperado + n, sizeof(esperado) - (size_t)n, "\n");
+    }
+
+    bool ok = true;
+    for (size_t livres = 0; livres < 64 && ok; livres++) {
+        EscritorSaida e;
+        int contador;
+        if (!escritorMemoria(&e)) {
+            ok = false;
+            break;
+        }
+        size_t inicio = e.capacidade - livres; // enche o buffer até só sobrarem "livres" bytes
+        memset(e.buffer, '.', inicio);
+        e.usados = inicio;
+        ok = listarAntenasEscritor(g, &e, &contador);
+        size_t tamanho;
+        char* texto = retirarTextoEscritor(&e, &tamanho);
+        ok = ok && texto && tamanho == inicio + (size_t)n && memcmp(texto + inicio, esperado, (size_t)n) == 0;
+        free(texto);
+    }
+    DestruirGrafo(g, &sucesso);
+    return ok;
+}
+
+/// @brief Uma verificação e o seu nome
+typedef struct Verificacao {
+    const char* nome;          ///< Nome mostrado se falhar
+    bool (*correr)(void);      ///< Devolve true se a verificação passar
+} Verificacao;
+
+int main(void)
+{
+    const Verificacao verificacoes[] = {
+        { "listagem com buffer igual à do printf", verificarEscritor },
+    };
+    size_t total = sizeof(verificacoes) / sizeof(verificacoes[0]);
+    size_t falhadas = 0;
+    for (size_t i = 0; i < total; i++) {
+        if (!verificacoes[i].correr()) {
+            fprintf(stderr, "FALHOU: %s\n", verificacoes[i].nome);
+            falhadas++;
+        }
+    }
+    printf("%zu de %zu verificações passaram.\n", total - falhadas, total);
+    return falhadas ? 1 : 0;
+}